@@ -1,13 +1,54 @@
 #include <iostream>
 #include <vector>
-#include <queue>
 #include <unordered_map>
 #include <string>
+#include <string_view>
 #include <cmath>
 #include <limits>
 #include <algorithm>
 #include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <optional>
+#include <climits>
+#include <cerrno>
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <functional>
+#include <random>
+#include <chrono>
 using namespace std;
+// Spreadsheet-style column name: A..Z, then AA, AB, ...
+string columnName(int x) {
+ string name;
+ for (int n = x + 1; n > 0; n = (n - 1) / 26) {
+ name.insert(name.begin(), char('A' + (n - 1) % 26));
+ }
+ return name;
+}
+// Parses a cell name such as "N1" or "AB12" into zero-based x and y
+bool parseCoordinateName(const string& coordinate, int& x, int& y) {
+ size_t split = 0;
+ x = -1;
+ while (split < coordinate.size() && isupper(static_cast<unsigned char>(coordinate[split]))) {
+ x = (x + 1) * 26 + (coordinate[split] - 'A');
+ split++;
+ }
+ int row = (split < coordinate.size()) ? atoi(coordinate.c_str() + split) : 0;
+ y = row - 1;
+ return x >= 0 && row > 0;
+}
 // Zone types
 enum ZoneType {
  HOT_ZONE, // High frequency items (close to entry)
@@ -21,10 +62,11 @@ struct Shelf {
  int maxCapacity;
  int currentLoad;
  string itemStored; // Single item per shelf
+ double depotDistance; // Metric distance to the nearest dock
  
  Shelf(int x = 0, int y = 0, string coordName = "", ZoneType z = COLD_ZONE) 
  : x(x), y(y), coordinateName(coordName), zone(z), maxCapacity(1000), currentLoad(0), 
-itemStored("") {}
+itemStored(""), depotDistance(0.0) {}
  
  bool isEmpty() const {
  return itemStored.empty();
@@ -43,36 +85,357 @@ itemStored("") {}
  itemStored = "";
  currentLoad = 0;
  }
+};
+// Structure to represent a location in the warehouse
+struct Location {
+ int x, y;
+ string name;
+ string coordinateName;
+ 
+ Location(int x = 0, int y = 0, string name = "", string coordName = "") 
+ : x(x), y(y), name(name), coordinateName(coordName) {}
+};
+// Grid walk from (x, y) to (toX, toY), along the row and then the column,
+// calling visit(x, y) for every cell entered
+template<typename Visit>
+void walkTo(int& x, int& y, int toX, int toY, Visit& visit) {
+ while (x != toX) {
+ x += (toX > x) ? 1 : -1;
+ visit(x, y);
+ }
+ while (y != toY) {
+ y += (toY > y) ? 1 : -1;
+ visit(x, y);
+ }
+}
+// Distance-metric policies. WarehouseSystem is a template over one of these,
+// so the metric inlines into the routing and placement loops. The system
+// holds a Metric instance, so a policy may also carry precomputed state.
+// walk() yields the cells a picker passes through between two cells, for
+// printed directions and the path-density map.
+struct EuclideanMetric {
+ static constexpr const char* NAME = "Euclidean";
+ 
+ static double distance(int x1, int y1, int x2, int y2) {
+ double dx = x1 - x2, dy = y1 - y2;
+ return sqrt(dx * dx + dy * dy);
+ }
+ 
+ // Straight-line distance is an estimate; pickers still walk the grid
+ template<typename Visit>
+ static void walk(int x1, int y1, int x2, int y2, Visit visit) {
+ walkTo(x1, y1, x2, y2, visit);
+ }
+};
+struct ManhattanMetric {
+ static constexpr const char* NAME = "Manhattan";
+ 
+ static double distance(int x1, int y1, int x2, int y2) {
+ return abs(x1 - x2) + abs(y1 - y2);
+ }
  
- double distanceToEntry() {
- return sqrt(pow(x, 2) + pow(y, 2));
+ template<typename Visit>
+ static void walk(int x1, int y1, int x2, int y2, Visit visit) {
+ walkTo(x1, y1, x2, y2, visit);
+ }
+};
+// Rectilinear travel through aisles: pickers move freely along a column,
+// but can only change column on a cross-aisle (rows 1, 1 + SPACING, ...,
+// i.e. y % SPACING == 0).
+template<int SPACING>
+struct AisleMetric {
+ static_assert(SPACING > 0, "Cross-aisle spacing must be positive");
+ static constexpr const char* NAME = "Rectilinear with aisles";
+ 
+ static double distance(int x1, int y1, int x2, int y2) {
+ int dx = abs(x1 - x2);
+ int lo = min(y1, y2), hi = max(y1, y2);
+ if (dx == 0) return hi - lo;
+ 
+ // A cross-aisle between the two rows costs nothing extra
+ int below = (lo / SPACING) * SPACING;
+ int above = below + SPACING;
+ if (below == lo || above <= hi) return dx + (hi - lo);
+ 
+ // Otherwise detour to the nearest cross-aisle below or above both
+ int viaBelow = (lo - below) + (hi - below);
+ int viaAbove = (above - lo) + (above - hi);
+ return dx + min(viaBelow, viaAbove);
+ }
+ 
+ // Along the column to a cross-aisle, across it, then along the target
+ // column: the aisle nearest the start between the two rows, or else the
+ // cheaper detour, so the steps add up to distance()
+ template<typename Visit>
+ static void walk(int x1, int y1, int x2, int y2, Visit visit) {
+ if (x1 != x2) {
+ int lo = min(y1, y2), hi = max(y1, y2);
+ int below = (lo / SPACING) * SPACING;
+ int above = below + SPACING;
+ int aisle;
+ if (below == lo || above <= hi) {
+ aisle = (y1 > y2) ? (hi / SPACING) * SPACING : (below == lo ? lo : above);
+ } else {
+ aisle = ((lo - below) + (hi - below) <= (above - lo) + (above - hi)) ? below : above;
+ }
+ walkTo(x1, y1, x1, aisle, visit);
+ }
+ walkTo(x1, y1, x2, y2, visit);
  }
 };
+// Floor bound policies. DynamicBounds sizes the floor from the shelves;
+// FixedBounds<W, H> makes the extent a compile-time constant.
+struct DynamicBounds {
+ static constexpr bool FIXED = false;
+ static constexpr int WIDTH = 0, HEIGHT = 0;
+};
+template<int W, int H>
+struct FixedBounds {
+ static_assert(W > 0 && H > 0, "Floor bounds must be positive");
+ static constexpr bool FIXED = true;
+ static constexpr int WIDTH = W, HEIGHT = H;
+};
+// Compact handle for an item record
+typedef uint32_t ItemId;
 // Structure for an item with frequency
 struct Item {
+ ItemId id; // Index in the ItemTable, fixed when the name is interned
  string name;
  int frequency; // Access frequency out of 100
  int size; // Size of item
  Shelf* assignedShelf;
+ Location location; // Pick location of the assigned shelf
+ uint32_t orderedEpoch; // Last frequency update that saw this item ordered
+ uint64_t movedVersion; // First snapshot showing its current shelf (or none)
  
- Item(string n, int freq, int s) 
- : name(n), frequency(freq), size(s), assignedShelf(nullptr) {}
+ Item(string n = "", int freq = 0, int s = 0) 
+ : id(0), name(n), frequency(freq), size(s), assignedShelf(nullptr), orderedEpoch(0), 
+ movedVersion(0) {}
+ 
+ void assignTo(Shelf* shelf) {
+ assignedShelf = shelf;
+ location = Location(shelf->x, shelf->y, name, shelf->coordinateName);
+ }
 };
-// Structure to represent a location in the warehouse
-struct Location {
- int x, y;
- string name;
- string coordinateName;
+// Chunked arena for records. IDs are dense indices and addresses never move,
+// so records can be referenced by ID or pointer for the life of the pool.
+template<typename T>
+class RecordPool {
+private:
+ static const size_t CHUNK_SIZE = 1024;
+ vector<unique_ptr<T[]>> chunks;
+ size_t count = 0;
  
- Location(int x = 0, int y = 0, string name = "", string coordName = "") 
- : x(x), y(y), name(name), coordinateName(coordName) {}
+public:
+ uint32_t add(T record) {
+ if (count % CHUNK_SIZE == 0) {
+ chunks.push_back(make_unique<T[]>(CHUNK_SIZE));
+ }
+ chunks[count / CHUNK_SIZE][count % CHUNK_SIZE] = move(record);
+ return static_cast<uint32_t>(count++);
+ }
+ 
+ T& operator[](uint32_t id) {
+ return chunks[id / CHUNK_SIZE][id % CHUNK_SIZE];
+ }
  
- double distanceTo(const Location& other) const {
- return sqrt(pow(x - other.x, 2) + pow(y - other.y, 2));
+ const T& operator[](uint32_t id) const {
+ return chunks[id / CHUNK_SIZE][id % CHUNK_SIZE];
+ }
+ 
+ size_t size() const { return count; }
+};
+// Chunked array whose chunks are shared between copies: a copy costs one
+// pointer per chunk, and a write clones only the chunk it lands in while an
+// older copy still holds it. Published snapshots are copies, so publishing
+// and then changing a few entries costs a few chunks, not the whole array.
+// Copies must be made and destroyed on the writer's thread (the snapshot
+// publisher does both), since the share check reads the use count.
+template<typename T, size_t CHUNK_SIZE = 1024>
+class CowArray {
+private:
+ vector<shared_ptr<vector<T>>> chunks;
+ size_t count = 0;
+ 
+ vector<T>& ownChunk(size_t chunk) {
+ if (chunks[chunk].use_count() > 1) {
+ chunks[chunk] = make_shared<vector<T>>(*chunks[chunk]);
+ }
+ return *chunks[chunk];
+ }
+ 
+public:
+ class const_iterator {
+ private:
+ const CowArray* array;
+ size_t index;
+ 
+ public:
+ const_iterator(const CowArray* a, size_t i) : array(a), index(i) {}
+ const T& operator*() const { return (*array)[index]; }
+ const T* operator->() const { return &(*array)[index]; }
+ const_iterator& operator++() { index++; return *this; }
+ bool operator!=(const const_iterator& other) const { return index != other.index; }
+ };
+ 
+ void assign(size_t n, const T& value) {
+ chunks.clear();
+ count = 0;
+ for (size_t i = 0; i < n; i++) push_back(value);
+ }
+ 
+ void push_back(const T& value) {
+ if (count % CHUNK_SIZE == 0) {
+ chunks.push_back(make_shared<vector<T>>());
+ chunks.back()->reserve(CHUNK_SIZE);
+ }
+ ownChunk(chunks.size() - 1).push_back(value);
+ count++;
+ }
+ 
+ const T& operator[](size_t i) const {
+ return (*chunks[i / CHUNK_SIZE])[i % CHUNK_SIZE];
+ }
+ 
+ // Writable entry; unshares its chunk first
+ T& mutate(size_t i) {
+ return ownChunk(i / CHUNK_SIZE)[i % CHUNK_SIZE];
+ }
+ 
+ size_t size() const { return count; }
+ 
+ const_iterator begin() const { return const_iterator(this, 0); }
+ const_iterator end() const { return const_iterator(this, count); }
+};
+// Flat open-addressing (linear probing) index from names to dense IDs.
+// Names are not stored here: lookups take a keyOf(id) callback returning
+// the name owned by the caller's record. Slots live in a CowArray, so a
+// copy shares every chunk that has not been written since.
+class NameIndex {
+private:
+ struct Slot {
+ size_t hash; // 0 marks an empty slot
+ uint32_t id;
+ };
+ 
+ CowArray<Slot> slots;
+ size_t count = 0;
+ 
+ void grow() {
+ CowArray<Slot> oldSlots = move(slots);
+ slots = CowArray<Slot>();
+ slots.assign(oldSlots.size() == 0 ? 16 : oldSlots.size() * 2, Slot{0, 0});
+ size_t mask = slots.size() - 1;
+ 
+ // Names are unique, so rehashing only needs the first free slot
+ for (const auto& slot : oldSlots) {
+ if (slot.hash == 0) continue;
+ size_t i = slot.hash & mask;
+ while (slots[i].hash != 0) i = (i + 1) & mask;
+ slots.mutate(i) = slot;
+ }
+ }
+ 
+ // Returns the slot holding name, or the empty slot ending its chain
+ template<typename KeyOf>
+ size_t probe(string_view name, size_t h, KeyOf keyOf) const {
+ size_t mask = slots.size() - 1;
+ size_t i = h & mask;
+ while (slots[i].hash != 0 && !(slots[i].hash == h && keyOf(slots[i].id) == name)) {
+ i = (i + 1) & mask;
+ }
+ return i;
+ }
+ 
+public:
+ static size_t hashName(string_view name) {
+ size_t h = hash<string_view>()(name);
+ return (h == 0) ? 1 : h;
+ }
+ 
+ // Returns a pointer to the ID stored for name, or nullptr
+ template<typename KeyOf>
+ const uint32_t* find(string_view name, KeyOf keyOf) const {
+ if (count == 0) return nullptr;
+ size_t i = probe(name, hashName(name), keyOf);
+ return (slots[i].hash != 0) ? &slots[i].id : nullptr;
+ }
+ 
+ // Adds a name known to be absent
+ void insert(string_view name, uint32_t id) {
+ if ((count + 1) * 10 > slots.size() * 7) grow();
+ size_t h = hashName(name);
+ size_t mask = slots.size() - 1;
+ size_t i = h & mask;
+ while (slots[i].hash != 0) i = (i + 1) & mask;
+ slots.mutate(i) = Slot{h, id};
+ count++;
+ }
+};
+// Item catalog: records live in a RecordPool and a NameIndex maps names to
+// their IDs. Every name seen - stocked or only referenced by an order - is
+// interned once, so order lines can carry an ItemId instead of a string.
+class ItemTable {
+private:
+ RecordPool<Item> records;
+ NameIndex index;
+ 
+ const uint32_t* lookup(string_view name) const {
+ return index.find(name, [this](uint32_t id) -> string_view { 
+ return records[id].name; 
+ });
+ }
+ 
+public:
+ // Returns the stocked item with this name, or nullptr
+ Item* find(string_view name) {
+ const uint32_t* id = lookup(name);
+ if (id == nullptr) return nullptr;
+ Item& item = records[*id];
+ return (item.assignedShelf != nullptr) ? &item : nullptr;
+ }
+ 
+ const Item* find(string_view name) const {
+ const uint32_t* id = lookup(name);
+ if (id == nullptr) return nullptr;
+ const Item& item = records[*id];
+ return (item.assignedShelf != nullptr) ? &item : nullptr;
+ }
+ 
+ // Returns the ID already assigned to name, without interning it
+ optional<ItemId> idOf(string_view name) const {
+ const uint32_t* id = lookup(name);
+ if (id == nullptr) return nullopt;
+ return *id;
+ }
+ 
+ // Returns the ID for name, creating an unstocked record on first sight
+ ItemId intern(string_view name) {
+ const uint32_t* id = lookup(name);
+ if (id != nullptr) return *id;
+ ItemId newId = records.add(Item(string(name)));
+ records[newId].id = newId;
+ index.insert(name, newId);
+ return newId;
+ }
+ 
+ // Number of interned names; IDs run from 0 to size() - 1
+ size_t size() const { return records.size(); }
+ 
+ const NameIndex& nameIndex() const { return index; }
+ 
+ Item& at(ItemId id) { return records[id]; }
+ 
+ const Item& at(ItemId id) const { return records[id]; }
+ 
+ // Visits stocked items in the order they were first interned
+ template<typename Func>
+ void forEach(Func func) {
+ for (size_t id = 0; id < records.size(); id++) {
+ if (records[id].assignedShelf != nullptr) func(records[id]);
+ }
  }
 };
-
-
 // Structure for an item in the order
 struct OrderItem {
  string itemName;
@@ -92,38 +455,960 @@ struct Order {
  items.push_back(OrderItem(itemName, quantity));
  }
 };
+// Read-only copy of an item inside a snapshot. Names never change once
+// interned and records never move, so the view points at the live name.
+struct ItemView {
+ string_view name;
+ int frequency;
+ int size;
+ int shelfIndex; // -1 when not stocked
+};
+// Immutable, versioned copy of the floor for readers. Item views are
+// indexed by ItemId and the name index is shared layout with ItemTable.
+// The large arrays share unchanged chunks with the previous snapshot.
+struct WarehouseSnapshot {
+ uint64_t version = 0;
+ vector<Location> docks;
+ CowArray<Shelf, 128> shelves;
+ CowArray<ItemView> items;
+ NameIndex names;
+ int floorWidth = 0, floorHeight = 0;
+ CowArray<uint32_t> pathDensity; // Picker visits per floor cell, row-major
+ size_t primeOrders = 0;
+ size_t regularOrders = 0;
+ 
+ // Returns the ID of the stocked item with this name, or nullopt
+ optional<ItemId> idOf(string_view name) const {
+ const uint32_t* id = names.find(name, [this](uint32_t i) -> string_view { 
+ return items[i].name; 
+ });
+ if (id == nullptr || items[*id].shelfIndex < 0) return nullopt;
+ return *id;
+ }
+ 
+ // Returns the stocked item with this name, or nullptr
+ const ItemView* find(string_view name) const {
+ optional<ItemId> id = idOf(name);
+ return id ? &items[*id] : nullptr;
+ }
+ 
+ const Shelf& shelfOf(const ItemView& item) const {
+ return shelves[item.shelfIndex];
+ }
+};
+// RCU-style publication of snapshots. The single writer swaps in a new
+// snapshot with one atomic exchange, then advances the epoch. Readers pin
+// the epoch in a slot of their own and load the current pointer, so they
+// never take a lock. A replaced snapshot is retired with the epoch it was
+// current in and freed by a later publish once every pinned epoch is newer,
+// so a steady stream of readers holds back only the snapshots it can see.
+class SnapshotPublisher {
+private:
+ static const size_t READER_SLOTS = 64; // Readers alive at once; more wait for a slot
+ 
+ struct Retired {
+ uint64_t epoch; // Last epoch in which it was current
+ unique_ptr<const WarehouseSnapshot> snapshot;
+ };
+ 
+ atomic<const WarehouseSnapshot*> current{nullptr};
+ atomic<uint64_t> epoch{1};
+ atomic<uint64_t> readerEpochs[READER_SLOTS] = {}; // 0: slot free
+ vector<Retired> retired; // Oldest first
+ 
+ // Claims a free slot holding the current epoch. The epoch is re-read after
+ // pinning, so a publish either sees the pin or has already swapped in the
+ // snapshot this reader will load.
+ atomic<uint64_t>* pin() {
+ uint64_t now = epoch.load();
+ for (size_t i = 0;; i = (i + 1) % READER_SLOTS) {
+ uint64_t expected = 0;
+ if (!readerEpochs[i].compare_exchange_strong(expected, now)) {
+ if (i == READER_SLOTS - 1) this_thread::yield();
+ continue;
+ }
+ for (uint64_t seen = epoch.load(); seen != now; seen = epoch.load()) {
+ now = seen;
+ readerEpochs[i].store(now);
+ }
+ return &readerEpochs[i];
+ }
+ }
+ 
+public:
+ // Pins the snapshot that was current when it was created
+ class Reader {
+ private:
+ atomic<uint64_t>* slot;
+ const WarehouseSnapshot* snapshot;
+ 
+ public:
+ explicit Reader(SnapshotPublisher& publisher) : slot(publisher.pin()) {
+ snapshot = publisher.current.load();
+ }
+ 
+ ~Reader() {
+ slot->store(0);
+ }
+ 
+ Reader(const Reader&) = delete;
+ Reader& operator=(const Reader&) = delete;
+ 
+ const WarehouseSnapshot& operator*() const { return *snapshot; }
+ const WarehouseSnapshot* operator->() const { return snapshot; }
+ };
+ 
+ SnapshotPublisher() = default;
+ SnapshotPublisher(const SnapshotPublisher&) = delete;
+ SnapshotPublisher& operator=(const SnapshotPublisher&) = delete;
+ 
+ ~SnapshotPublisher() {
+ delete current.load();
+ }
+ 
+ // Writer only
+ void publish(unique_ptr<const WarehouseSnapshot> next) {
+ const WarehouseSnapshot* previous = current.exchange(next.release());
+ uint64_t retiredAt = epoch.fetch_add(1);
+ if (previous != nullptr) {
+ retired.push_back(Retired{retiredAt, unique_ptr<const WarehouseSnapshot>(previous)});
+ }
+ 
+ uint64_t oldestPinned = numeric_limits<uint64_t>::max();
+ for (const auto& slot : readerEpochs) {
+ uint64_t pinned = slot.load();
+ if (pinned != 0) oldestPinned = min(oldestPinned, pinned);
+ }
+ size_t unseen = 0;
+ while (unseen < retired.size() && retired[unseen].epoch < oldestPinned) unseen++;
+ retired.erase(retired.begin(), retired.begin() + unseen);
+ }
+};
+// Rectangle of floor cells to draw
+struct Viewport {
+ int x0, y0;
+ int width, height;
+ 
+ bool contains(int x, int y) const {
+ return x >= x0 && x < x0 + width && y >= y0 && y < y0 + height;
+ }
+};
+// Character map drawn into one contiguous buffer: a line of column names,
+// then one line per floor row (highest y first), every cell 3 characters
+// wide. The whole frame is written to the stream with a single call.
+class TextCanvas {
+private:
+ static const int LABEL_WIDTH = 5;
+ static const int CELL_WIDTH = 3;
+ Viewport view;
+ size_t lineLength;
+ string buffer;
+ 
+ // Writes text right-aligned into a field ending at offset end
+ void putRight(size_t end, string_view text, size_t width) {
+ if (text.size() > width) text = text.substr(text.size() - width);
+ buffer.replace(end - text.size(), text.size(), text.data(), text.size());
+ }
+ 
+ size_t cellEnd(int x, int y) const {
+ size_t line = 1 + (view.y0 + view.height - 1 - y);
+ return line * lineLength + LABEL_WIDTH + (x - view.x0 + 1) * CELL_WIDTH;
+ }
+ 
+public:
+ explicit TextCanvas(const Viewport& viewport) : view(viewport) {
+ lineLength = LABEL_WIDTH + view.width * CELL_WIDTH + 1;
+ buffer.assign(lineLength * (view.height + 1), ' ');
+ 
+ for (int x = view.x0; x < view.x0 + view.width; x++) {
+ putRight(LABEL_WIDTH + (x - view.x0 + 1) * CELL_WIDTH, columnName(x), CELL_WIDTH);
+ }
+ buffer[lineLength - 1] = '\n';
+ 
+ for (int y = view.y0; y < view.y0 + view.height; y++) {
+ size_t lineStart = (1 + (view.y0 + view.height - 1 - y)) * lineLength;
+ putRight(lineStart + LABEL_WIDTH - 1, to_string(y + 1), LABEL_WIDTH - 1);
+ for (int x = view.x0; x < view.x0 + view.width; x++) {
+ buffer[cellEnd(x, y) - 1] = '.';
+ }
+ buffer[lineStart + lineLength - 1] = '\n';
+ }
+ }
+ 
+ // Labels longer than a cell keep their last characters
+ void put(int x, int y, string_view label) {
+ if (!view.contains(x, y)) return;
+ size_t end = cellEnd(x, y);
+ buffer.replace(end - CELL_WIDTH, CELL_WIDTH, CELL_WIDTH, ' ');
+ putRight(end, label, CELL_WIDTH);
+ }
+ 
+ void print(ostream& out) const {
+ out.write(buffer.data(), buffer.size());
+ }
+};
+// Layers available for heat maps
+enum HeatLayer {
+ HEAT_OCCUPANCY, // Share of shelves holding an item
+ HEAT_FREQUENCY, // Mean access frequency of stored items
+ HEAT_PATH_DENSITY // Picker visits, relative to the busiest bucket
+};
+// Downsampled floor: each bucket covers scale x scale cells and holds a
+// value in [0, 1], or -1 where the bucket has no shelf (or no traffic).
+struct HeatMap {
+ int width, height;
+ int scale;
+ vector<float> values; // row-major, y = 0 first
+ 
+ // Buckets are square; the longer floor side is cut into at most maxBuckets
+ static HeatMap build(const WarehouseSnapshot& snapshot, HeatLayer layer, int maxBuckets) {
+ HeatMap map;
+ int longest = max(1, max(snapshot.floorWidth, snapshot.floorHeight));
+ map.scale = (longest + maxBuckets - 1) / maxBuckets;
+ map.width = (snapshot.floorWidth + map.scale - 1) / map.scale;
+ map.height = (snapshot.floorHeight + map.scale - 1) / map.scale;
+ size_t bucketCount = static_cast<size_t>(map.width) * map.height;
+ vector<float> sums(bucketCount, 0.0f);
+ vector<uint32_t> counts(bucketCount, 0);
+ 
+ auto bucketOf = [&](int x, int y) {
+ return static_cast<size_t>(y / map.scale) * map.width + x / map.scale;
+ };
+ 
+ if (layer == HEAT_PATH_DENSITY) {
+ float busiest = 0.0f;
+ for (int y = 0; y < snapshot.floorHeight; y++) {
+ for (int x = 0; x < snapshot.floorWidth; x++) {
+ uint32_t hits = snapshot.pathDensity[static_cast<size_t>(y) * snapshot.floorWidth + x];
+ if (hits == 0) continue;
+ size_t b = bucketOf(x, y);
+ sums[b] += hits;
+ counts[b] = 1;
+ busiest = max(busiest, sums[b]);
+ }
+ }
+ for (auto& sum : sums) sum /= max(busiest, 1.0f);
+ } else {
+ if (layer == HEAT_OCCUPANCY) {
+ for (const auto& shelf : snapshot.shelves) {
+ size_t b = bucketOf(shelf.x, shelf.y);
+ sums[b] += shelf.isEmpty() ? 0.0f : 1.0f;
+ counts[b]++;
+ }
+ } else {
+ for (const auto& item : snapshot.items) {
+ if (item.shelfIndex < 0) continue;
+ const Shelf& shelf = snapshot.shelfOf(item);
+ size_t b = bucketOf(shelf.x, shelf.y);
+ sums[b] += item.frequency / 100.0f;
+ counts[b]++;
+ }
+ }
+ for (size_t b = 0; b < bucketCount; b++) {
+ if (counts[b] > 0) sums[b] /= counts[b];
+ }
+ }
+ 
+ map.values.resize(bucketCount);
+ for (size_t b = 0; b < bucketCount; b++) {
+ map.values[b] = (counts[b] > 0) ? sums[b] : -1.0f;
+ }
+ return map;
+ }
+ 
+ // Blue (cold) to red (hot); buckets without data are dark grey
+ static void colorOf(float value, unsigned char rgb[3]) {
+ if (value < 0) {
+ rgb[0] = rgb[1] = rgb[2] = 40;
+ return;
+ }
+ rgb[0] = static_cast<unsigned char>(255 * value);
+ rgb[1] = static_cast<unsigned char>(255 * (1.0f - fabs(2 * value - 1)) * 0.6f);
+ rgb[2] = static_cast<unsigned char>(255 * (1.0f - value));
+ }
+ 
+ // Binary PPM (P6), pixelsPerBucket pixels square per bucket, north up
+ bool writePPM(const string& path, int pixelsPerBucket) const {
+ ofstream file(path, ios::binary);
+ if (!file) return false;
+ int pixelWidth = width * pixelsPerBucket;
+ int pixelHeight = height * pixelsPerBucket;
+ file << "P6\n" << pixelWidth << " " << pixelHeight << "\n255\n";
+ 
+ vector<unsigned char> row(static_cast<size_t>(pixelWidth) * 3);
+ for (int by = height - 1; by >= 0; by--) {
+ for (int bx = 0; bx < width; bx++) {
+ unsigned char rgb[3];
+ colorOf(values[static_cast<size_t>(by) * width + bx], rgb);
+ for (int p = 0; p < pixelsPerBucket; p++) {
+ memcpy(&row[(static_cast<size_t>(bx) * pixelsPerBucket + p) * 3], rgb, 3);
+ }
+ }
+ for (int p = 0; p < pixelsPerBucket; p++) {
+ file.write(reinterpret_cast<const char*>(row.data()), row.size());
+ }
+ }
+ return static_cast<bool>(file);
+ }
+ 
+ // SVG with one rect per horizontal run of equal colour, north up
+ bool writeSVG(const string& path, int pixelsPerBucket) const {
+ ofstream file(path);
+ if (!file) return false;
+ file << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << width * pixelsPerBucket 
+ << "\" height=\"" << height * pixelsPerBucket << "\" shape-rendering=\"crispEdges\">\n";
+ 
+ for (int by = 0; by < height; by++) {
+ int top = (height - 1 - by) * pixelsPerBucket;
+ int runStart = 0;
+ unsigned char runColor[3];
+ colorOf(values[static_cast<size_t>(by) * width], runColor);
+ for (int bx = 1; bx <= width; bx++) {
+ unsigned char rgb[3] = {0, 0, 0};
+ if (bx < width) colorOf(values[static_cast<size_t>(by) * width + bx], rgb);
+ if (bx < width && memcmp(rgb, runColor, 3) == 0) continue;
+ file << "<rect x=\"" << runStart * pixelsPerBucket << "\" y=\"" << top 
+ << "\" width=\"" << (bx - runStart) * pixelsPerBucket 
+ << "\" height=\"" << pixelsPerBucket << "\" fill=\"rgb(" 
+ << int(runColor[0]) << "," << int(runColor[1]) << "," << int(runColor[2]) << ")\"/>\n";
+ runStart = bx;
+ memcpy(runColor, rgb, 3);
+ }
+ }
+ file << "</svg>\n";
+ return static_cast<bool>(file);
+ }
+};
+// Columns of shelves owned by one warehouse instance (all by default)
+struct ShelfRegion {
+ int minX = 0;
+ int maxX = INT_MAX;
+ 
+ bool contains(int x) const {
+ return x >= minX && x <= maxX;
+ }
+};
+// Outcome of processing one order
+struct OrderResult {
+ int orderId = -1; // -1 when no order was pending
+ int picked = 0;
+ int missing = 0;
+ double distance = 0.0;
+};
+// Item to be placed by a bulk put-away
+struct PutAwayRequest {
+ string name;
+ int frequency;
+ int size;
+};
+// Free shelves for an item of some frequency, and how near the shelf it
+// would get (the best in its zone, else the best anywhere) is to a dock
+struct ShelfAvailability {
+ int inZone = 0;
+ int total = 0;
+ double nearest = 0.0; // Dock distance of that shelf; meaningless when total == 0
+};
+// Outcome of a bulk put-away
+struct PutAwayReport {
+ int placed = 0;
+ vector<pair<string, string>> rejections; // item (or file line), reason
+};
+// Reads a receipt file with one "name,frequency,size" per line. Blank lines
+// and lines starting with '#' are skipped; malformed lines are reported by
+// line number. Returns false if the file cannot be opened.
+bool readPutAwayFile(const string& path, vector<PutAwayRequest>& requests, 
+ vector<pair<string, string>>& malformed) {
+ ifstream file(path);
+ if (!file) {
+ cout << "Error: Cannot open " << path << "\n";
+ return false;
+ }
+ 
+ string line;
+ int lineNumber = 0;
+ while (getline(file, line)) {
+ lineNumber++;
+ if (line.empty() || line[0] == '#') continue;
+ 
+ size_t firstComma = line.find(',');
+ size_t lastComma = line.rfind(',');
+ PutAwayRequest request;
+ char trailing;
+ istringstream numbers(firstComma == lastComma ? "" : 
+ line.substr(firstComma + 1, lastComma - firstComma - 1) + " " + 
+ line.substr(lastComma + 1));
+ if (firstComma == 0 || firstComma == string::npos || 
+ !(numbers >> request.frequency >> request.size) || (numbers >> trailing)) {
+ malformed.push_back({"line " + to_string(lineNumber), "Malformed entry"});
+ continue;
+ }
+ request.name = line.substr(0, firstComma);
+ requests.push_back(request);
+ }
+ 
+ cout << "Read " << requests.size() << " items from " << path;
+ if (!malformed.empty()) {
+ cout << " (" << malformed.size() << " malformed lines skipped)";
+ }
+ cout << "\n";
+ for (const auto& entry : malformed) {
+ cout << " ✗ " << entry.first << ": " << entry.second << "\n";
+ }
+ return true;
+}
+// Order line resolved to a compact item ID
+struct OrderLine {
+ ItemId item;
+ int quantity;
+};
+// Queued order header; its lines live in the current wave's OrderBatch
+struct QueuedOrder {
+ int orderId;
+ bool isPrime;
+ uint32_t firstLine;
+ uint32_t lineCount;
+};
+// Arena for the order lines of queued orders. Resetting when the queues
+// drain keeps the capacity, so steady-state intake is allocation-free; under
+// intake that never drains, dropBefore() discards the consumed prefix.
+// Names the catalog does not know (typos, discontinued SKUs) are kept here
+// rather than interned, and are dropped with their lines.
+struct OrderBatch {
+ static const ItemId UNKNOWN_ITEM = 0x80000000u; // | index into unknownNames
+ 
+ vector<OrderLine> lines;
+ vector<string> unknownNames;
+ 
+ static bool isUnknown(ItemId item) { return (item & UNKNOWN_ITEM) != 0; }
+ 
+ uint32_t append(ItemId item, int quantity) {
+ lines.push_back(OrderLine{item, quantity});
+ return static_cast<uint32_t>(lines.size() - 1);
+ }
+ 
+ // Sentinel ID for a line naming an item outside the catalog
+ ItemId unknown(string_view name) {
+ unknownNames.emplace_back(name);
+ return UNKNOWN_ITEM | static_cast<ItemId>(unknownNames.size() - 1);
+ }
+ 
+ const string& unknownName(ItemId item) const {
+ return unknownNames[item & ~UNKNOWN_ITEM];
+ }
+ 
+ const OrderLine* linesOf(const QueuedOrder& order) const {
+ return lines.data() + order.firstLine;
+ }
+ 
+ void reset() {
+ lines.clear();
+ unknownNames.clear();
+ }
+ 
+ // Discards lines[0 .. first) and renumbers the unknown names the rest
+ // use; the caller shifts every queued header's firstLine down by first
+ void dropBefore(uint32_t first) {
+ lines.erase(lines.begin(), lines.begin() + first);
+ size_t kept = 0;
+ for (auto& line : lines) {
+ if (!isUnknown(line.item)) continue;
+ unknownNames[kept] = move(unknownNames[line.item & ~UNKNOWN_ITEM]);
+ line.item = UNKNOWN_ITEM | static_cast<ItemId>(kept++);
+ }
+ unknownNames.resize(kept);
+ }
+};
+// Item lines of the most recent committed orders, kept as the trace for
+// what-if scoring. Holds at most maxOrders orders; the oldest go first.
+class OrderHistory {
+private:
+ size_t maxOrders;
+ deque<uint32_t> lengths; // Lines per kept order, oldest first
+ deque<ItemId> lines;
+ 
+public:
+ explicit OrderHistory(size_t limit) : maxOrders(max<size_t>(1, limit)) {}
+ 
+ void add(const vector<ItemId>& order) {
+ lines.insert(lines.end(), order.begin(), order.end());
+ lengths.push_back(static_cast<uint32_t>(order.size()));
+ if (lengths.size() > maxOrders) {
+ lines.erase(lines.begin(), lines.begin() + lengths.front());
+ lengths.pop_front();
+ }
+ }
+ 
+ size_t size() const { return lengths.size(); }
+ 
+ // Visits kept orders oldest first as func(const vector<ItemId>&)
+ template<typename Func>
+ void forEach(Func func) const {
+ vector<ItemId> order;
+ auto next = lines.begin();
+ for (uint32_t length : lengths) {
+ order.assign(next, next + length);
+ next += length;
+ func(order);
+ }
+ }
+};
 // Comparator for priority queue
 struct OrderComparator {
- bool operator()(const Order& a, const Order& b) const {
+ bool operator()(const QueuedOrder& a, const QueuedOrder& b) const {
  if (a.isPrime != b.isPrime)
  return !a.isPrime;
  return a.orderId > b.orderId;
  }
 };
-// Warehouse Management System Class
-class WarehouseSystem {
+// One stop on a tour: a pick or a dock (where a tour starts or drops off).
+// Routes carry only cells and IDs; names are looked up when displayed.
+struct RouteStop {
+ static const uint32_t DOCK_STOP = 0x80000000; // Flags ref as a dock index
+ 
+ int x, y;
+ uint32_t ref; // ItemId of the pick, or DOCK_STOP | dock index
+ 
+ bool isDock() const { return (ref & DOCK_STOP) != 0; }
+ uint32_t dockIndex() const { return ref & ~DOCK_STOP; }
+ bool sameAs(const RouteStop& other) const {
+ return x == other.x && y == other.y && ref == other.ref;
+ }
+};
+// An order as it moves through the processing stages:
+// intake -> resolve locations -> plan route -> dispatch -> commit
+struct PipelineOrder {
+ uint64_t sequence = 0;
+ QueuedOrder order{};
+ uint64_t snapshotVersion = 0; // Snapshot the locations were resolved against
+ vector<RouteStop> destinations; // Picks in order-line order
+ string pickList; // Formatted "Items in this order" lines
+ int missing = 0;
+ vector<RouteStop> route; // Start dock, picks, drop dock
+ int picker = 0; // Picker the order is assigned to: sequence % pickers
+ 
+ // Clears the per-order data but keeps buffer capacity for reuse
+ void reset(uint64_t seq, const QueuedOrder& queued) {
+ sequence = seq;
+ order = queued;
+ picker = 0;
+ snapshotVersion = 0;
+ destinations.clear();
+ pickList.clear();
+ missing = 0;
+ route.clear();
+ }
+};
+// Per-stage settings for pipelined processing. Dispatch and commit share one
+// thread, so every route is checked against the state all earlier orders
+// left behind, and output and state changes stay in order.
+struct PipelineConfig {
+ size_t queueCapacity = 8; // Orders buffered between stages and in flight (backpressure)
+ int resolveWorkers = 1;
+ int planWorkers = 1; // Threads only: any count yields the same routes
+ int pickers = 1; // Order i goes to picker i % pickers
+};
+// Blocking FIFO with a fixed capacity: push waits while full, pop waits while
+// empty. close() wakes everyone; pop then drains what is left.
+template<typename T>
+class BoundedQueue {
 private:
- Location entryPoint;
+ mutex lock;
+ condition_variable notFull, notEmpty;
+ deque<T> entries;
+ size_t capacity;
+ bool closed = false;
+ 
+public:
+ explicit BoundedQueue(size_t maxEntries) : capacity(max<size_t>(1, maxEntries)) {}
+ 
+ bool push(T entry) {
+ unique_lock<mutex> guard(lock);
+ notFull.wait(guard, [this] { return closed || entries.size() < capacity; });
+ if (closed) return false;
+ entries.push_back(move(entry));
+ notEmpty.notify_one();
+ return true;
+ }
+ 
+ bool pop(T& entry) {
+ unique_lock<mutex> guard(lock);
+ notEmpty.wait(guard, [this] { return closed || !entries.empty(); });
+ if (entries.empty()) return false;
+ entry = move(entries.front());
+ entries.pop_front();
+ notFull.notify_one();
+ return true;
+ }
+ 
+ void close() {
+ lock_guard<mutex> guard(lock);
+ closed = true;
+ notFull.notify_all();
+ notEmpty.notify_all();
+ }
+};
+// Threads kept alive between jobs. run(job) calls job(worker) once on every
+// pool thread and once on the caller (worker 0), and returns when all calls
+// have finished, so per-job cost is a wake-up rather than a thread start.
+class WorkerPool {
+private:
+ vector<thread> threads;
+ mutex lock;
+ condition_variable wake, finished;
+ const function<void(size_t)>* job = nullptr;
+ uint64_t generation = 0;
+ size_t running = 0;
+ bool stopping = false;
+ 
+ void loop(size_t worker) {
+ uint64_t seen = 0;
+ unique_lock<mutex> guard(lock);
+ while (true) {
+ wake.wait(guard, [&] { return stopping || generation != seen; });
+ if (stopping) return;
+ seen = generation;
+ const function<void(size_t)>& task = *job;
+ guard.unlock();
+ task(worker);
+ guard.lock();
+ if (--running == 0) finished.notify_one();
+ }
+ }
+ 
+public:
+ explicit WorkerPool(size_t workers) {
+ for (size_t w = 1; w < workers; w++) {
+ threads.emplace_back([this, w] { loop(w); });
+ }
+ }
+ 
+ WorkerPool(const WorkerPool&) = delete;
+ WorkerPool& operator=(const WorkerPool&) = delete;
+ 
+ ~WorkerPool() {
+ {
+ lock_guard<mutex> guard(lock);
+ stopping = true;
+ }
+ wake.notify_all();
+ for (auto& t : threads) t.join();
+ }
+ 
+ size_t size() const { return threads.size() + 1; }
+ 
+ void run(const function<void(size_t)>& task) {
+ {
+ lock_guard<mutex> guard(lock);
+ job = &task;
+ running = threads.size();
+ generation++;
+ }
+ wake.notify_all();
+ task(0);
+ unique_lock<mutex> guard(lock);
+ finished.wait(guard, [this] { return running == 0; });
+ }
+};
+// What-if scoring of a slotting against a trace of past orders. Each order
+// is walked the way the live system routes it - nearest-neighbour picks from
+// the entry dock, then on to the dock nearest the last pick - and its travel
+// is cached. Moving or swapping items re-scores only the orders containing
+// them, so candidate swaps cost a few tours each rather than the whole trace.
+template<typename Metric>
+class LayoutEvaluator {
+public:
+ struct Cell {
+ int x, y; // x < 0: not stocked (order lines for it are skipped)
+ };
+ 
+private:
+ struct Scratch {
+ vector<Cell> points;
+ vector<char> visited;
+ };
+ 
+ static const size_t SCORE_BLOCK = 256; // Orders per work unit in parallel scoring
+ static const size_t PARALLEL_RESCORE = 512; // Fewer affected orders re-score inline
+ 
+ Metric metric;
+ vector<Cell> docks; // docks[0] is where every tour starts
+ vector<Cell> placement; // Indexed by ItemId
+ vector<uint32_t> orderStarts{0}; // Order i is lines[orderStarts[i] .. orderStarts[i + 1])
+ vector<ItemId> lines;
+ vector<vector<uint32_t>> ordersOf; // Inverted index: item -> orders containing it
+ vector<double> orderCost;
+ double total = 0.0;
+ unique_ptr<WorkerPool> pool; // Null when scoring on one thread
+ vector<Scratch> workerScratch; // One per pool worker
+ 
+ // Scratch for incremental updates
+ Scratch scratch;
+ vector<uint32_t> affected;
+ vector<uint32_t> affectedMark; // Per order: last markEpoch it was queued in
+ uint32_t markEpoch = 0;
+ 
+ double dist(const Cell& a, const Cell& b) const {
+ return metric.distance(a.x, a.y, b.x, b.y);
+ }
+ 
+ // Same visiting order and tie-breaks as planOpenTour; allocation-free once
+ // the scratch buffers have grown
+ double tourCost(size_t order, Scratch& work) const {
+ work.points.clear();
+ for (uint32_t i = orderStarts[order]; i < orderStarts[order + 1]; i++) {
+ const Cell& cell = placement[lines[i]];
+ if (cell.x >= 0) work.points.push_back(cell);
+ }
+ if (work.points.empty()) return 0.0;
+ work.visited.assign(work.points.size(), 0);
+ 
+ double travelled = 0.0;
+ Cell current = docks[0];
+ for (size_t step = 0; step < work.points.size(); step++) {
+ double minDist = numeric_limits<double>::max();
+ size_t nearest = 0;
+ for (size_t i = 0; i < work.points.size(); i++) {
+ if (work.visited[i]) continue;
+ double d = dist(current, work.points[i]);
+ if (d < minDist) {
+ minDist = d;
+ nearest = i;
+ }
+ }
+ work.visited[nearest] = 1;
+ travelled += minDist;
+ current = work.points[nearest];
+ }
+ 
+ const Cell* drop = &docks[0];
+ for (const auto& dock : docks) {
+ if (dist(current, dock) < dist(current, *drop)) drop = &dock;
+ }
+ return travelled + dist(current, *drop);
+ }
+ 
+ // Scores orders[0 .. count) (or every order when orders is null) on the
+ // pool, handing out blocks of SCORE_BLOCK through a shared counter
+ void scoreParallel(const uint32_t* orders, size_t count) {
+ if (pool == nullptr) {
+ for (size_t i = 0; i < count; i++) {
+ size_t order = (orders != nullptr) ? orders[i] : i;
+ orderCost[order] = tourCost(order, scratch);
+ }
+ return;
+ }
+ 
+ atomic<size_t> nextBlock{0};
+ pool->run([&](size_t worker) {
+ Scratch& local = workerScratch[worker];
+ for (size_t first = nextBlock.fetch_add(SCORE_BLOCK); first < count; 
+ first = nextBlock.fetch_add(SCORE_BLOCK)) {
+ size_t last = min(count, first + SCORE_BLOCK);
+ for (size_t i = first; i < last; i++) {
+ size_t order = (orders != nullptr) ? orders[i] : i;
+ orderCost[order] = tourCost(order, local);
+ }
+ }
+ });
+ }
+ 
+ void queueOrdersOf(ItemId item) {
+ for (uint32_t order : ordersOf[item]) {
+ if (affectedMark[order] != markEpoch) {
+ affectedMark[order] = markEpoch;
+ affected.push_back(order);
+ }
+ }
+ }
+ 
+ // Re-scores the queued orders and folds the change into the total
+ double rescoreAffected() {
+ double before = 0.0, after = 0.0;
+ for (uint32_t order : affected) before += orderCost[order];
+ if (affected.size() >= PARALLEL_RESCORE) {
+ scoreParallel(affected.data(), affected.size());
+ } else {
+ for (uint32_t order : affected) orderCost[order] = tourCost(order, scratch);
+ }
+ for (uint32_t order : affected) after += orderCost[order];
+ total += after - before;
+ return total;
+ }
+ 
+ void beginUpdate() {
+ affected.clear();
+ if (++markEpoch == 0) {
+ fill(affectedMark.begin(), affectedMark.end(), 0);
+ markEpoch = 1;
+ }
+ }
+ 
+public:
+ // placement[id] is the shelf cell of item id. threads = 0 uses every core;
+ // the threads are started once and reused by every scoring call.
+ LayoutEvaluator(vector<Cell> dockCells, vector<Cell> itemCells, unsigned threads = 0)
+ : docks(move(dockCells)), placement(move(itemCells)), ordersOf(placement.size()) {
+ if (docks.empty()) docks.push_back(Cell{0, 0});
+ unsigned threadCount = (threads != 0) ? threads : max(1u, thread::hardware_concurrency());
+ if (threadCount > 1) {
+ pool = make_unique<WorkerPool>(threadCount);
+ workerScratch.resize(threadCount);
+ }
+ }
+ 
+ // Appends an order to the trace; call evaluate() before reading costs
+ void addOrder(const ItemId* ids, size_t count) {
+ uint32_t order = static_cast<uint32_t>(orderCost.size());
+ for (size_t i = 0; i < count; i++) {
+ lines.push_back(ids[i]);
+ vector<uint32_t>& containing = ordersOf[ids[i]];
+ if (containing.empty() || containing.back() != order) containing.push_back(order);
+ }
+ orderStarts.push_back(static_cast<uint32_t>(lines.size()));
+ orderCost.push_back(0.0);
+ affectedMark.push_back(0);
+ }
+ 
+ // Scores the whole trace from scratch and returns the total travel
+ double evaluate() {
+ scoreParallel(nullptr, orderCost.size());
+ total = 0.0;
+ for (double cost : orderCost) total += cost;
+ return total;
+ }
+ 
+ // Re-slots one item and returns the new total
+ double moveItem(ItemId item, Cell to) {
+ beginUpdate();
+ placement[item] = to;
+ queueOrdersOf(item);
+ return rescoreAffected();
+ }
+ 
+ // Exchanges two items' shelves and returns the new total; swapping the
+ // same pair again restores the previous layout and costs
+ double swapItems(ItemId a, ItemId b) {
+ beginUpdate();
+ swap(placement[a], placement[b]);
+ queueOrdersOf(a);
+ queueOrdersOf(b);
+ return rescoreAffected();
+ }
+ 
+ double totalCost() const { return total; }
+ 
+ double costOf(size_t order) const { return orderCost[order]; }
+ 
+ size_t orderCount() const { return orderCost.size(); }
+ 
+ // Orders re-scored by the last moveItem or swapItems
+ size_t lastAffected() const { return affected.size(); }
+ 
+ const Cell& cellOf(ItemId item) const { return placement[item]; }
+};
+// Extent of the built-in shelf layout
+const int LAYOUT_WIDTH = 14, LAYOUT_HEIGHT = 11;
+// Warehouse Management System Class, specialised at build time on the
+// distance metric and floor bounds (see the WarehouseSystem typedef)
+template<typename Metric = EuclideanMetric, typename Bounds = DynamicBounds>
+class BasicWarehouseSystem {
+private:
+ Metric metric;
+ ShelfRegion region;
+ vector<Location> docks; // Dock doors / pack stations; docks[0] is the entry point
+ uint32_t pickerDock = 0; // Dock the picker's next tour starts from
  vector<Shelf> shelves;
- unordered_map<string, Item*> items;
- unordered_map<string, Location> itemLocations;
- queue<Order> regularOrderQueue;
- priority_queue<Order, vector<Order>, OrderComparator> primeOrderQueue;
+ ItemTable items;
+ OrderBatch orderBatch;
+ vector<QueuedOrder> regularOrderQueue; // FIFO, consumed from regularHead
+ size_t regularHead = 0;
+ vector<QueuedOrder> primeOrderQueue; // Heap ordered by OrderComparator
+ uint32_t frequencyEpoch = 0;
+ 
+ // Floor extent (shelves and entry) and picker traffic per cell
+ int floorWidth = 0, floorHeight = 0;
+ CowArray<uint32_t> pathDensity;
+ 
+ SnapshotPublisher snapshots;
+ uint64_t snapshotVersion = 0;
+ 
+ // Reader-side copies of the shelves and item views, refreshed from the
+ // entries changed since the last publish and shared with the snapshots
+ CowArray<Shelf, 128> publishedShelves;
+ CowArray<ItemView> publishedItems;
+ vector<uint32_t> changedShelves;
+ vector<ItemId> changedItems;
+ bool allShelvesChanged = true, allItemsChanged = true;
+ 
+ // Trace for what-if scoring; about a week of orders at a small site
+ static const size_t ORDER_HISTORY_LIMIT = 50000;
+ OrderHistory history{ORDER_HISTORY_LIMIT};
+ 
+ // Scratch buffers reused across orders
+ PipelineOrder currentWork;
+ vector<RouteStop> plannedDestinations;
+ vector<ItemId> committedLines;
+ vector<Item*> itemsToMove;
  
  const int HOT_ZONE_THRESHOLD = 60;
+ static const uint32_t MIN_RECLAIM_LINES = 4096; // Smaller prefixes are not worth the shift
  const int FREQUENCY_INCREMENT = 2; // Increase by 2 when ordered
  const int FREQUENCY_DECREMENT = 1; // Decrease by 1 when not ordered
  
- string getCoordinateName(int x, int y) {
- char column = 'A' + x;
+ static_assert(!Bounds::FIXED || 
+ (Bounds::WIDTH >= LAYOUT_WIDTH && Bounds::HEIGHT >= LAYOUT_HEIGHT), 
+ "Fixed floor bounds must cover the shelf layout");
+ 
+ double distance(const RouteStop& a, const RouteStop& b) const {
+ return metric.distance(a.x, a.y, b.x, b.y);
+ }
+ 
+ // Placement order: nearest to any dock under the site metric, so shelves
+ // are ranked by the same distance the router walks
+ bool closerToDock(const Shelf& a, const Shelf& b) const {
+ return a.depotDistance < b.depotDistance;
+ }
+ 
+ // Stores each shelf's metric distance to its nearest dock
+ void computeDepotDistances() {
+ for (auto& shelf : shelves) {
+ shelf.depotDistance = numeric_limits<double>::max();
+ for (const auto& dock : docks) {
+ shelf.depotDistance = min(shelf.depotDistance, 
+ metric.distance(shelf.x, shelf.y, dock.x, dock.y));
+ }
+ }
+ allShelvesChanged = true;
+ }
+ 
+ RouteStop dockStop(uint32_t index) const {
+ return RouteStop{docks[index].x, docks[index].y, RouteStop::DOCK_STOP | index};
+ }
+ 
+ uint32_t nearestDockTo(const RouteStop& stop) const {
+ uint32_t best = 0;
+ for (uint32_t i = 1; i < docks.size(); i++) {
+ if (metric.distance(stop.x, stop.y, docks[i].x, docks[i].y) < 
+ metric.distance(stop.x, stop.y, docks[best].x, docks[best].y)) best = i;
+ }
+ return best;
+ }
+ 
+ // Display name for a stop; only the printed route needs it
+ const string& stopName(const RouteStop& stop) const {
+ return stop.isDock() ? docks[stop.dockIndex()].name : items.at(stop.ref).name;
+ }
+ 
+ string getCoordinateName(int x, int y) const {
  int row = y + 1;
- return string(1, column) + to_string(row);
+ return columnName(x) + to_string(row);
  }
  
  void initializeShelves() {
  // Hot Zone - 3x3 area near entry
  for (int y = 1; y <= 3; y++) {
  for (int x = 1; x <= 3; x++) {
+ if (!region.contains(x)) continue;
  string coordName = getCoordinateName(x, y);
  shelves.push_back(Shelf(x, y, coordName, HOT_ZONE));
  }
@@ -132,6 +1417,7 @@ private:
  // Cold Zone - rest of warehouse
  for (int y = 1; y <= 10; y++) {
  for (int x = 4; x <= 13; x++) {
+ if (!region.contains(x)) continue;
  string coordName = getCoordinateName(x, y);
  shelves.push_back(Shelf(x, y, coordName, COLD_ZONE));
  }
@@ -139,10 +1425,35 @@ private:
  
  for (int y = 4; y <= 10; y++) {
  for (int x = 1; x <= 3; x++) {
+ if (!region.contains(x)) continue;
  string coordName = getCoordinateName(x, y);
  shelves.push_back(Shelf(x, y, coordName, COLD_ZONE));
  }
  }
+ 
+ if constexpr (Bounds::FIXED) {
+ floorWidth = Bounds::WIDTH;
+ floorHeight = Bounds::HEIGHT;
+ } else {
+ floorWidth = docks[0].x + 1;
+ floorHeight = docks[0].y + 1;
+ for (const auto& shelf : shelves) {
+ floorWidth = max(floorWidth, shelf.x + 1);
+ floorHeight = max(floorHeight, shelf.y + 1);
+ }
+ }
+ pathDensity.assign(static_cast<size_t>(floorWidth) * floorHeight, 0);
+ }
+ 
+ // Returns an error message if the item parameters are out of range
+ const char* checkItemSpec(int frequency, int size) const {
+ if (frequency < 0 || frequency > 100) {
+ return "Frequency must be between 0-100";
+ }
+ if (size <= 0 || size > 1000) {
+ return "Item size must be between 1-1000";
+ }
+ return nullptr;
  }
  
  Shelf* findBestShelf(int frequency, int itemSize) {
@@ -150,13 +1461,10 @@ private:
 COLD_ZONE;
  
  Shelf* bestShelf = nullptr;
- double minDistance = numeric_limits<double>::max();
  
  for (auto& shelf : shelves) {
  if (shelf.zone == targetZone && shelf.canStore(itemSize)) {
- double dist = shelf.distanceToEntry();
- if (dist < minDistance) {
- minDistance = dist;
+ if (bestShelf == nullptr || closerToDock(shelf, *bestShelf)) {
  bestShelf = &shelf;
  }
  }
@@ -165,9 +1473,7 @@ COLD_ZONE;
  if (bestShelf == nullptr) {
  for (auto& shelf : shelves) {
  if (shelf.canStore(itemSize)) {
- double dist = shelf.distanceToEntry();
- if (dist < minDistance) {
- minDistance = dist;
+ if (bestShelf == nullptr || closerToDock(shelf, *bestShelf)) {
  bestShelf = &shelf;
  }
  }
@@ -177,46 +1483,71 @@ COLD_ZONE;
  return bestShelf;
  }
  
- vector<Location> generateWaypoints(Location from, Location to) {
- vector<Location> waypoints;
- int dx = to.x - from.x;
- int dy = to.y - from.y;
- int currentX = from.x;
- int currentY = from.y;
+ // Counts every cell walked on the path, as the metric routes each leg
+ // (an aisle detour may pass beyond the floor; those cells are not kept)
+ void recordPathDensity(const vector<RouteStop>& path) {
+ auto count = [this](int x, int y) {
+ if (x < floorWidth && y < floorHeight) {
+ pathDensity.mutate(static_cast<size_t>(y) * floorWidth + x)++;
+ }
+ };
+ for (size_t i = 0; i + 1 < path.size(); i++) {
+ count(path[i].x, path[i].y);
+ metric.walk(path[i].x, path[i].y, path[i + 1].x, path[i + 1].y, count);
+ }
+ }
+ 
+ // Text maps larger than this are clipped; heat map exports cover the floor
+ static constexpr int MAX_TEXT_MAP_SIZE = 60;
+ 
+ Viewport textViewport(int x0, int y0) const {
+ x0 = max(0, min(x0, floorWidth - MAX_TEXT_MAP_SIZE));
+ y0 = max(0, min(y0, floorHeight - MAX_TEXT_MAP_SIZE));
+ return Viewport{x0, y0, min(floorWidth, MAX_TEXT_MAP_SIZE), 
+ min(floorHeight, MAX_TEXT_MAP_SIZE)};
+ }
  
- int stepX = (dx > 0) ? 1 : -1;
- for (int i = 0; i < abs(dx); i++) {
- currentX += stepX;
- string coordName = getCoordinateName(currentX, currentY);
- waypoints.push_back(Location(currentX, currentY, "Waypoint", coordName));
+ void printViewportNote(const Viewport& view) const {
+ if (view.width < floorWidth || view.height < floorHeight) {
+ cout << "(Showing " << getCoordinateName(view.x0, view.y0) << " to " 
+ << getCoordinateName(view.x0 + view.width - 1, view.y0 + view.height - 1) 
+ << "; export a heat map for the full floor)\n";
+ }
  }
  
- int stepY = (dy > 0) ? 1 : -1;
- for (int i = 0; i < abs(dy); i++) {
- currentY += stepY;
- string coordName = getCoordinateName(currentX, currentY);
- waypoints.push_back(Location(currentX, currentY, "Waypoint", coordName));
+ // Cells walked from one stop to the next, as the metric routes the leg
+ void printWaypoints(const RouteStop& from, const RouteStop& to) const {
+ metric.walk(from.x, from.y, to.x, to.y, [this](int x, int y) {
+ cout << " -> " << getCoordinateName(x, y);
+ });
  }
  
- return waypoints;
+ // Catalog ID for an order line, looking up names that were unknown at intake
+ optional<ItemId> lineItem(const OrderLine& line) const {
+ if (!OrderBatch::isUnknown(line.item)) return line.item;
+ return items.idOf(orderBatch.unknownName(line.item));
  }
  
  // Update frequencies based on order processing
- void updateFrequencies(const Order& order) {
+ void updateFrequencies(const QueuedOrder& order) {
  cout << "\n=== Updating Item Frequencies ===\n";
  
- // Collect ordered items
- unordered_map<string, bool> orderedItems;
- for (const auto& orderItem : order.items) {
- orderedItems[orderItem.itemName] = true;
+ // Stamp ordered items with this update's epoch; every stocked item's
+ // frequency moves, so the whole item view is refreshed on publish
+ frequencyEpoch++;
+ allItemsChanged = true;
+ const OrderLine* lines = orderBatch.linesOf(order);
+ for (uint32_t i = 0; i < order.lineCount; i++) {
+ optional<ItemId> id = lineItem(lines[i]);
+ if (id) items.at(*id).orderedEpoch = frequencyEpoch;
  }
  
  // Update all items
- for (auto& pair : items) {
- Item* item = pair.second;
+ items.forEach([&](Item& entry) {
+ Item* item = &entry;
  int oldFreq = item->frequency;
  
- if (orderedItems.find(item->name) != orderedItems.end()) {
+ if (item->orderedEpoch == frequencyEpoch) {
  // Item was ordered - increase frequency
  item->frequency = min(100, item->frequency + FREQUENCY_INCREMENT);
  if (item->frequency != oldFreq) {
@@ -231,18 +1562,18 @@ COLD_ZONE;
  << item->frequency << " (not ordered)\n";
  }
  }
- }
+ });
  }
  
  // Check and rebalance zones based on updated frequencies
  void rebalanceZones() {
  cout << "\n=== Checking Zone Assignments ===\n";
  
- vector<Item*> itemsToMove;
+ itemsToMove.clear();
  
  // Check all items for zone mismatch
- for (auto& pair : items) {
- Item* item = pair.second;
+ items.forEach([&](Item& entry) {
+ Item* item = &entry;
  bool shouldBeHot = (item->frequency >= HOT_ZONE_THRESHOLD);
  bool isInHotZone = (item->assignedShelf->zone == HOT_ZONE);
  
@@ -255,7 +1586,7 @@ COLD_ZONE;
  << ") should move to COLD zone\n";
  itemsToMove.push_back(item);
  }
- }
+ });
  
  if (itemsToMove.empty()) {
  cout << " ✓ All items are in correct zones\n";
@@ -270,17 +1601,16 @@ COLD_ZONE;
  string oldLocation = oldShelf->coordinateName;
  string oldZone = (oldShelf->zone == HOT_ZONE) ? "HOT" : "COLD";
  oldShelf->removeItem();
+ markChanged(oldShelf);
+ markChanged(*item);
  
  // Find new shelf
  Shelf* newShelf = findBestShelf(item->frequency, item->size);
  
  if (newShelf != nullptr) {
  newShelf->addItem(item->name, item->size);
- item->assignedShelf = newShelf;
- 
- // Update location mapping
- Location loc(newShelf->x, newShelf->y, item->name, newShelf->coordinateName);
- itemLocations[item->name] = loc;
+ item->assignTo(newShelf);
+ markChanged(newShelf);
  
  string newZone = (newShelf->zone == HOT_ZONE) ? "HOT" : "COLD";
  cout << " ✓ Moved '" << item->name << "' from " << oldZone 
@@ -294,140 +1624,639 @@ COLD_ZONE;
  }
  }
  
+ void markChanged(const Shelf* shelf) {
+ changedShelves.push_back(static_cast<uint32_t>(shelf - shelves.data()));
+ }
+ 
+ // Also stamps the item with the next snapshot version, so routes resolved
+ // against an earlier snapshot can tell it moved
+ void markChanged(Item& item) {
+ item.movedVersion = snapshotVersion + 1;
+ changedItems.push_back(item.id);
+ }
+ 
+ ItemView viewOf(ItemId id) const {
+ const Item& item = items.at(id);
+ int shelfIndex = (item.assignedShelf != nullptr) 
+ ? static_cast<int>(item.assignedShelf - shelves.data()) : -1;
+ return ItemView{item.name, item.frequency, item.size, shelfIndex};
+ }
+ 
+ // Publishes a new snapshot for readers. Only shelves and items marked
+ // changed since the last publish are copied; the rest of each array, the
+ // name index and the density grid share chunks with earlier snapshots.
+ void publishSnapshot() {
+ if (allShelvesChanged) {
+ publishedShelves = CowArray<Shelf, 128>();
+ for (const auto& shelf : shelves) publishedShelves.push_back(shelf);
+ } else {
+ for (uint32_t index : changedShelves) publishedShelves.mutate(index) = shelves[index];
+ }
+ if (allItemsChanged) {
+ for (ItemId id = 0; id < publishedItems.size(); id++) publishedItems.mutate(id) = viewOf(id);
+ } else {
+ for (ItemId id : changedItems) {
+ if (id < publishedItems.size()) publishedItems.mutate(id) = viewOf(id);
+ }
+ }
+ for (ItemId id = publishedItems.size(); id < items.size(); id++) {
+ publishedItems.push_back(viewOf(id));
+ }
+ changedShelves.clear();
+ changedItems.clear();
+ allShelvesChanged = allItemsChanged = false;
+ 
+ auto snapshot = make_unique<WarehouseSnapshot>();
+ snapshot->version = ++snapshotVersion;
+ snapshot->docks = docks;
+ snapshot->shelves = publishedShelves;
+ snapshot->items = publishedItems;
+ snapshot->names = items.nameIndex();
+ snapshot->floorWidth = floorWidth;
+ snapshot->floorHeight = floorHeight;
+ snapshot->pathDensity = pathDensity;
+ snapshot->primeOrders = primeOrderQueue.size();
+ snapshot->regularOrders = regularOrderQueue.size() - regularHead;
+ snapshots.publish(move(snapshot));
+ }
+ 
+ // Stage 1 (intake): next order, prime first
+ bool takeNextOrder(QueuedOrder& next) {
+ if (!primeOrderQueue.empty()) {
+ next = primeOrderQueue.front();
+ pop_heap(primeOrderQueue.begin(), primeOrderQueue.end(), OrderComparator());
+ primeOrderQueue.pop_back();
+ return true;
+ }
+ if (regularHead < regularOrderQueue.size()) {
+ next = regularOrderQueue[regularHead++];
+ return true;
+ }
+ return false;
+ }
+ 
+ // Recycles order lines no queued order still needs: all of them once the
+ // queues drain, otherwise the consumed prefix once it is at least half the
+ // arena (amortised O(1) per line). Keeps the arena and firstLine bounded
+ // by the outstanding orders rather than by everything since start-up.
+ void reclaimOrderLines() {
+ if (!hasPendingOrders()) {
+ orderBatch.reset();
+ regularOrderQueue.clear();
+ regularHead = 0;
+ return;
+ }
+ 
+ uint32_t oldest = static_cast<uint32_t>(orderBatch.lines.size());
+ for (const auto& order : primeOrderQueue) oldest = min(oldest, order.firstLine);
+ for (size_t i = regularHead; i < regularOrderQueue.size(); i++) {
+ oldest = min(oldest, regularOrderQueue[i].firstLine);
+ }
+ if (oldest < MIN_RECLAIM_LINES || oldest < orderBatch.lines.size() - oldest) return;
+ 
+ orderBatch.dropBefore(oldest);
+ regularOrderQueue.erase(regularOrderQueue.begin(), regularOrderQueue.begin() + regularHead);
+ regularHead = 0;
+ for (auto& order : primeOrderQueue) order.firstLine -= oldest;
+ for (auto& order : regularOrderQueue) order.firstLine -= oldest;
+ }
+ 
+ // One "Items in this order" line; shelf is null for items not in stock
+ static void appendPickLine(string& list, string_view name, int quantity, const Shelf* shelf) {
+ if (shelf == nullptr) {
+ list += " - " + string(name) + " - NOT FOUND!\n";
+ return;
+ }
+ list += " + " + string(name) + " (Qty: " + to_string(quantity) + ") at " + 
+ shelf->coordinateName + (shelf->zone == HOT_ZONE ? " [HOT]\n" : " [COLD]\n");
+ }
+ 
+ // Stage 2: resolve order lines to pick locations. Reads only a snapshot,
+ // so it can run while the commit stage changes the live state.
+ void resolveOrder(PipelineOrder& work) {
+ SnapshotPublisher::Reader view = readView();
+ work.snapshotVersion = view->version;
+ 
+ const OrderLine* lines = orderBatch.linesOf(work.order);
+ for (uint32_t i = 0; i < work.order.lineCount; i++) {
+ ItemId id = lines[i].item;
+ if (OrderBatch::isUnknown(id)) {
+ // Not in the catalog at intake; it may have been stocked since
+ const string& name = orderBatch.unknownName(id);
+ optional<ItemId> stocked = view->idOf(name);
+ if (!stocked) {
+ appendPickLine(work.pickList, name, lines[i].quantity, nullptr);
+ work.missing++;
+ continue;
+ }
+ id = *stocked;
+ }
+ const ItemView& item = view->items[id];
+ if (item.shelfIndex >= 0) {
+ const Shelf& shelf = view->shelfOf(item);
+ work.destinations.push_back(RouteStop{shelf.x, shelf.y, id});
+ appendPickLine(work.pickList, item.name, lines[i].quantity, &shelf);
+ } else {
+ appendPickLine(work.pickList, item.name, lines[i].quantity, nullptr);
+ work.missing++;
+ }
+ }
+ }
+ 
+ // Stage 3: plan the tour from the picker's station dock, which moves to
+ // the tour's drop dock
+ void planRoute(PipelineOrder& work, uint32_t& station) const {
+ if (work.destinations.empty()) return;
+ planOpenTour(station, work.destinations, work.route);
+ station = work.route.back().dockIndex();
+ }
+ 
+ // Resolves the order against the live state; writer thread only
+ void resolveLive(PipelineOrder& work) {
+ work.snapshotVersion = snapshotVersion;
+ work.destinations.clear();
+ work.pickList.clear();
+ work.missing = 0;
+ 
+ const OrderLine* lines = orderBatch.linesOf(work.order);
+ for (uint32_t i = 0; i < work.order.lineCount; i++) {
+ optional<ItemId> id = lineItem(lines[i]);
+ const Item* item = id ? &items.at(*id) : nullptr;
+ if (item != nullptr && item->assignedShelf != nullptr) {
+ work.destinations.push_back(RouteStop{item->location.x, item->location.y, *id});
+ appendPickLine(work.pickList, item->name, lines[i].quantity, item->assignedShelf);
+ } else {
+ string_view name = (item != nullptr) ? string_view(item->name) 
+ : string_view(orderBatch.unknownName(lines[i].item));
+ appendPickLine(work.pickList, name, lines[i].quantity, nullptr);
+ work.missing++;
+ }
+ }
+ }
+ 
+ // True if any item on the order was moved, stocked or released after the
+ // snapshot the order was resolved against
+ bool itemsMovedSince(const PipelineOrder& work) const {
+ const OrderLine* lines = orderBatch.linesOf(work.order);
+ for (uint32_t i = 0; i < work.order.lineCount; i++) {
+ optional<ItemId> id = lineItem(lines[i]);
+ if (id && items.at(*id).movedVersion > work.snapshotVersion) return true;
+ }
+ return false;
+ }
+ 
+ // Stage 4: hand the pick list and route to the picker standing at station.
+ // Runs on the writer thread after every earlier order has committed: if
+ // those commits moved any of this order's items, it is re-resolved, and
+ // the tour is re-planned when its picks changed or it was planned from
+ // somewhere other than station. The station then moves to the tour's end.
+ // Returns whether the route was re-planned.
+ bool dispatchOrder(PipelineOrder& work, uint32_t& station) {
+ bool replan = false;
+ if (itemsMovedSince(work)) {
+ plannedDestinations = work.destinations;
+ resolveLive(work);
+ replan = plannedDestinations.size() != work.destinations.size();
+ for (size_t i = 0; !replan && i < work.destinations.size(); i++) {
+ replan = !plannedDestinations[i].sameAs(work.destinations[i]);
+ }
+ }
+ if (!work.route.empty() && work.route.front().dockIndex() != station) {
+ replan = true;
+ }
+ if (replan) {
+ work.route.clear();
+ planRoute(work, station);
+ }
+ 
+ cout << "\n" << string(60, '=') << "\n";
+ cout << (work.order.isPrime ? " Processing PRIME Order #" : " Processing Regular Order #") 
+ << work.order.orderId << "\n";
+ cout << string(60, '=') << "\n";
+ cout << "\nItems in this order:\n" << work.pickList;
+ 
+ if (work.route.empty()) {
+ cout << "\nNo valid items. Order cannot be fulfilled.\n";
+ return replan;
+ }
+ cout << "\nCalculating optimal route...\n";
+ displayDetailedPath(work.route);
+ displayPathOnMap(work.route);
+ station = work.route.back().dockIndex();
+ return replan;
+ }
+ 
+ // Stage 5 (the only writer): record the dispatched tour, update
+ // frequencies and rebalance. The caller publishes the new state.
+ OrderResult commitOrder(const PipelineOrder& work) {
+ OrderResult result;
+ result.orderId = work.order.orderId;
+ result.missing = work.missing;
+ 
+ committedLines.clear();
+ const OrderLine* lines = orderBatch.linesOf(work.order);
+ for (uint32_t i = 0; i < work.order.lineCount; i++) {
+ optional<ItemId> id = lineItem(lines[i]);
+ if (id) committedLines.push_back(*id);
+ }
+ history.add(committedLines);
+ 
+ if (work.route.empty()) return result;
+ 
+ result.picked = static_cast<int>(work.destinations.size());
+ result.distance = calculatePathDistance(work.route);
+ recordPathDensity(work.route);
+ 
+ cout << "\n[OK] Order #" << work.order.orderId << " completed!\n";
+ 
+ // Update frequencies and rebalance zones
+ updateFrequencies(work.order);
+ rebalanceZones();
+ return result;
+ }
+ 
 public:
- WarehouseSystem(int entryX = 0, int entryY = 0) {
+ BasicWarehouseSystem(int entryX = 0, int entryY = 0, ShelfRegion shelfRegion = ShelfRegion()) 
+ : region(shelfRegion) {
+ if (Bounds::FIXED && (entryX < 0 || entryX >= Bounds::WIDTH || 
+ entryY < 0 || entryY >= Bounds::HEIGHT)) {
+ cout << "Error: Entry point outside the fixed floor bounds, using A1\n";
+ entryX = entryY = 0;
+ }
  string coordName = getCoordinateName(entryX, entryY);
- entryPoint = Location(entryX, entryY, "Entry Point", coordName);
+ docks.push_back(Location(entryX, entryY, "Entry Point", coordName));
  initializeShelves();
+ computeDepotDistances();
+ publishSnapshot();
  cout << "Warehouse initialized with " << shelves.size() << " shelves\n";
  cout << "Hot Zone Threshold: Frequency >= " << HOT_ZONE_THRESHOLD << "\n";
  cout << "Each shelf: ONE item only, 1000 unit capacity\n";
+ cout << "Distance metric: " << Metric::NAME << "\n";
  cout << "Frequency updates: +" << FREQUENCY_INCREMENT 
  << " when ordered, -" << FREQUENCY_DECREMENT << " when not\n";
  }
  
- void addItem(string itemName, int frequency, int size) {
- if (frequency < 0 || frequency > 100) {
- cout << "Error: Frequency must be between 0-100\n";
- return;
+ bool addItem(string itemName, int frequency, int size) {
+ const char* specError = checkItemSpec(frequency, size);
+ if (specError != nullptr) {
+ cout << "Error: " << specError << "\n";
+ return false;
  }
  
- if (size <= 0 || size > 1000) {
- cout << "Error: Item size must be between 1-1000\n";
- return;
+ if (items.find(itemName) != nullptr) {
+ cout << "Error: Item '" << itemName << "' is already stored\n";
+ return false;
  }
  
  Shelf* bestShelf = findBestShelf(frequency, size);
  
  if (bestShelf == nullptr) {
  cout << "Error: No available shelf for " << itemName << "\n";
- return;
+ return false;
  }
  
- Item* newItem = new Item(itemName, frequency, size);
- newItem->assignedShelf = bestShelf;
+ Item& newItem = items.at(items.intern(itemName));
+ newItem.frequency = frequency;
+ newItem.size = size;
+ newItem.assignTo(bestShelf);
  bestShelf->addItem(itemName, size);
- items[itemName] = newItem;
- 
- Location loc(bestShelf->x, bestShelf->y, itemName, bestShelf->coordinateName);
- itemLocations[itemName] = loc;
+ markChanged(bestShelf);
+ markChanged(newItem);
+ publishSnapshot();
  
  string zoneType = (bestShelf->zone == HOT_ZONE) ? "HOT ZONE" : "COLD ZONE";
  cout << "Added '" << itemName << "' (Freq: " << frequency << ", Size: " << size 
  << ") to " << zoneType << " at " << bestShelf->coordinateName << "\n";
+ return true;
+ }
+ 
+ // Removes a stored item from its shelf (e.g. to hand it to another
+ // warehouse) and returns what is needed to store it again
+ optional<PutAwayRequest> releaseItem(string_view itemName) {
+ Item* item = items.find(itemName);
+ if (item == nullptr) return nullopt;
+ 
+ PutAwayRequest released{item->name, item->frequency, item->size};
+ item->assignedShelf->removeItem();
+ markChanged(item->assignedShelf);
+ item->assignedShelf = nullptr;
+ markChanged(*item);
+ publishSnapshot();
+ cout << "Released '" << released.name << "'\n";
+ return released;
+ }
+ 
+ // Cools every stocked item as if ticks orders that missed all of them had
+ // been processed elsewhere, then rebalances. Partitioned mode sends these
+ // to shards with no part in an order, so their items decay as they would
+ // in one warehouse.
+ void decayFrequencies(int ticks) {
+ if (ticks <= 0) return;
+ allItemsChanged = true;
+ items.forEach([&](Item& item) {
+ item.frequency = max(0, item.frequency - ticks * FREQUENCY_DECREMENT);
+ });
+ rebalanceZones();
+ publishSnapshot();
+ }
+ 
+ // Free shelves for an item of this frequency, following findBestShelf's
+ // choice of zone
+ ShelfAvailability freeShelves(int frequency) const {
+ ZoneType targetZone = (frequency >= HOT_ZONE_THRESHOLD) ? HOT_ZONE : COLD_ZONE;
+ ShelfAvailability free;
+ double nearestInZone = numeric_limits<double>::max(), nearestAny = nearestInZone;
+ for (const auto& shelf : shelves) {
+ if (!shelf.isEmpty()) continue;
+ free.total++;
+ nearestAny = min(nearestAny, shelf.depotDistance);
+ if (shelf.zone == targetZone) {
+ free.inZone++;
+ nearestInZone = min(nearestInZone, shelf.depotDistance);
+ }
+ }
+ free.nearest = (free.inZone > 0) ? nearestInZone : nearestAny;
+ return free;
+ }
+ 
+ // Stored items whose shelf is in the wrong zone for their frequency
+ vector<PutAwayRequest> misplacedItems() {
+ vector<PutAwayRequest> misplaced;
+ items.forEach([&](const Item& item) {
+ bool shouldBeHot = (item.frequency >= HOT_ZONE_THRESHOLD);
+ if (shouldBeHot != (item.assignedShelf->zone == HOT_ZONE)) {
+ misplaced.push_back(PutAwayRequest{item.name, item.frequency, item.size});
+ }
+ });
+ return misplaced;
+ }
+ 
+ // Places a whole receipt in one pass: items sorted by frequency (highest
+ // first) are matched against free shelves sorted by dock distance, so each
+ // item gets the nearest free shelf of its zone, falling back to the nearest
+ // free shelf anywhere - the same rule as findBestShelf, in O(n log n).
+ PutAwayReport putAwayItems(vector<PutAwayRequest> requests) {
+ PutAwayReport report;
+ 
+ stable_sort(requests.begin(), requests.end(), 
+ [](const PutAwayRequest& a, const PutAwayRequest& b) { 
+ return a.frequency > b.frequency; 
+ });
+ 
+ vector<Shelf*> freeHot, freeCold;
+ for (auto& shelf : shelves) {
+ if (shelf.isEmpty()) {
+ (shelf.zone == HOT_ZONE ? freeHot : freeCold).push_back(&shelf);
+ }
+ }
+ auto byDistance = [this](Shelf* a, Shelf* b) { 
+ return closerToDock(*a, *b); 
+ };
+ stable_sort(freeHot.begin(), freeHot.end(), byDistance);
+ stable_sort(freeCold.begin(), freeCold.end(), byDistance);
+ size_t nextHot = 0, nextCold = 0;
+ 
+ for (const auto& request : requests) {
+ const char* specError = checkItemSpec(request.frequency, request.size);
+ if (specError != nullptr) {
+ report.rejections.push_back({request.name, specError});
+ continue;
+ }
+ if (items.find(request.name) != nullptr) {
+ report.rejections.push_back({request.name, "Already stored"});
+ continue;
+ }
+ 
+ bool hasHot = nextHot < freeHot.size();
+ bool hasCold = nextCold < freeCold.size();
+ bool useHot;
+ if (hasHot && hasCold) {
+ useHot = (request.frequency >= HOT_ZONE_THRESHOLD);
+ } else if (hasHot || hasCold) {
+ useHot = hasHot;
+ } else {
+ report.rejections.push_back({request.name, "No available shelf"});
+ continue;
+ }
+ 
+ // Shelf capacities are uniform, so the nearest free shelf is also the
+ // nearest one that fits; canStore only guards against oversize items.
+ Shelf* shelf = useHot ? freeHot[nextHot] : freeCold[nextCold];
+ if (!shelf->canStore(request.size)) {
+ report.rejections.push_back({request.name, "Exceeds shelf capacity"});
+ continue;
+ }
+ (useHot ? nextHot : nextCold)++;
+ 
+ Item& item = items.at(items.intern(request.name));
+ item.frequency = request.frequency;
+ item.size = request.size;
+ item.assignTo(shelf);
+ shelf->addItem(request.name, request.size);
+ markChanged(shelf);
+ markChanged(item);
+ report.placed++;
+ }
+ publishSnapshot();
+ 
+ cout << "Put-away complete: " << report.placed << " placed, " 
+ << report.rejections.size() << " rejected\n";
+ for (const auto& rejection : report.rejections) {
+ cout << " ✗ " << rejection.first << ": " << rejection.second << "\n";
+ }
+ return report;
+ }
+ 
+ // Bulk put-away from a receipt file (see readPutAwayFile)
+ PutAwayReport putAwayFromFile(const string& path) {
+ vector<PutAwayRequest> requests;
+ vector<pair<string, string>> malformed;
+ if (!readPutAwayFile(path, requests, malformed)) return PutAwayReport();
+ 
+ PutAwayReport report = putAwayItems(move(requests));
+ report.rejections.insert(report.rejections.end(), malformed.begin(), malformed.end());
+ return report;
  }
  
  void addOrder(const Order& order) {
- if (order.isPrime) {
- primeOrderQueue.push(order);
+ QueuedOrder queued{order.orderId, order.isPrime, 
+ static_cast<uint32_t>(orderBatch.lines.size()), 
+ static_cast<uint32_t>(order.items.size())};
+ for (const auto& orderItem : order.items) {
+ optional<ItemId> id = items.idOf(orderItem.itemName);
+ orderBatch.append(id ? *id : orderBatch.unknown(orderItem.itemName), orderItem.quantity);
+ }
+ 
+ if (queued.isPrime) {
+ primeOrderQueue.push_back(queued);
+ push_heap(primeOrderQueue.begin(), primeOrderQueue.end(), OrderComparator());
  cout << "Prime Order #" << order.orderId << " added to priority queue\n";
  } else {
- regularOrderQueue.push(order);
+ regularOrderQueue.push_back(queued);
  cout << "Regular Order #" << order.orderId << " added to queue\n";
  }
+ publishSnapshot();
  }
  
- Location* getItemLocation(string itemName) {
- if (itemLocations.find(itemName) != itemLocations.end()) {
- return &itemLocations[itemName];
+ static string dockList(const WarehouseSnapshot& snapshot) {
+ string list;
+ for (const auto& dock : snapshot.docks) {
+ if (!list.empty()) list += ", ";
+ list += dock.coordinateName;
  }
- return nullptr;
+ return list;
  }
  
- vector<Location> findOptimalPath(Location start, vector<Location> destinations) {
- vector<Location> optimalPath;
- optimalPath.push_back(start);
+ // Consistent read-only view of the floor; never blocks the writer
+ SnapshotPublisher::Reader readView() {
+ return SnapshotPublisher::Reader(snapshots);
+ }
  
- Location currentPos = start;
- vector<bool> visited(destinations.size(), false);
+ // Evaluator over the recent order history and the current slotting
+ LayoutEvaluator<Metric> layoutEvaluator(unsigned threads = 0) const {
+ typedef typename LayoutEvaluator<Metric>::Cell Cell;
+ vector<Cell> dockCells, itemCells(items.size(), Cell{-1, -1});
+ for (const auto& dock : docks) dockCells.push_back(Cell{dock.x, dock.y});
+ for (ItemId id = 0; id < items.size(); id++) {
+ const Item& item = items.at(id);
+ if (item.assignedShelf != nullptr) {
+ itemCells[id] = Cell{item.assignedShelf->x, item.assignedShelf->y};
+ }
+ }
  
- while (true) {
- double minDist = numeric_limits<double>::max();
- int nearestIdx = -1;
+ LayoutEvaluator<Metric> evaluator(move(dockCells), move(itemCells), threads);
+ history.forEach([&](const vector<ItemId>& order) {
+ evaluator.addOrder(order.data(), order.size());
+ });
+ evaluator.evaluate();
+ return evaluator;
+ }
+ 
+ // Reports how the order history's travel would change if two items
+ // traded shelves; the live layout is not touched
+ void whatIfSwap(string_view first, string_view second) const {
+ const Item* a = items.find(first);
+ const Item* b = items.find(second);
+ if (a == nullptr || b == nullptr) {
+ cout << "Error: Item '" << (a == nullptr ? first : second) << "' not found!\n";
+ return;
+ }
+ if (history.size() == 0) {
+ cout << "No order history yet - process some orders first.\n";
+ return;
+ }
  
- for (int i = 0; i < destinations.size(); i++) {
- if (!visited[i]) {
- double dist = currentPos.distanceTo(destinations[i]);
+ LayoutEvaluator<Metric> evaluator = layoutEvaluator();
+ double current = evaluator.totalCost();
+ double swapped = evaluator.swapItems(a->id, b->id);
+ 
+ cout << fixed << setprecision(2);
+ cout << "\n=== What-If: swap " << a->name << " (" << a->location.coordinateName 
+ << ") and " << b->name << " (" << b->location.coordinateName << ") ===\n";
+ cout << "Orders in history: " << evaluator.orderCount() 
+ << " (" << evaluator.lastAffected() << " affected)\n";
+ cout << "Current travel: " << current << " units\n";
+ cout << "With swap: " << swapped << " units\n";
+ cout << (swapped < current ? "Saves " : "Adds ") << abs(current - swapped) << " units\n";
+ }
+ 
+ optional<Location> getItemLocation(string_view itemName) {
+ SnapshotPublisher::Reader view = readView();
+ const ItemView* item = view->find(itemName);
+ if (item == nullptr) return nullopt;
+ const Shelf& shelf = view->shelfOf(*item);
+ return Location(shelf.x, shelf.y, string(item->name), shelf.coordinateName);
+ }
+ 
+ // Open tour into route (capacity reused): picks from the start dock in
+ // nearest-neighbour order, then finishes at the dock nearest the last pick
+ // instead of returning to start. The nearest remaining pick is rotated
+ // forward, so the rest keep their order and ties go to the earlier line.
+ void planOpenTour(uint32_t startDock, const vector<RouteStop>& picks, 
+ vector<RouteStop>& route) const {
+ route.clear();
+ route.push_back(dockStop(startDock));
+ route.insert(route.end(), picks.begin(), picks.end());
+ 
+ for (size_t next = 1; next < route.size(); next++) {
+ const RouteStop& current = route[next - 1];
+ size_t nearest = next;
+ double minDist = distance(current, route[next]);
+ for (size_t i = next + 1; i < route.size(); i++) {
+ double dist = distance(current, route[i]);
  if (dist < minDist) {
  minDist = dist;
- nearestIdx = i;
+ nearest = i;
  }
  }
+ rotate(route.begin() + next, route.begin() + nearest, route.begin() + nearest + 1);
  }
  
- if (nearestIdx == -1) break;
+ route.push_back(dockStop(nearestDockTo(route.back())));
+ }
  
- visited[nearestIdx] = true;
- optimalPath.push_back(destinations[nearestIdx]);
- currentPos = destinations[nearestIdx];
+ // Adds a dock door or pack station; tours may end at any dock and shelves
+ // are ranked by their distance to the nearest one
+ void addDock(int x, int y) {
+ if (x < 0 || x >= floorWidth || y < 0 || y >= floorHeight) {
+ cout << "Error: Dock must be inside the floor (A1 to " 
+ << getCoordinateName(floorWidth - 1, floorHeight - 1) << ")\n";
+ return;
+ }
+ for (const auto& dock : docks) {
+ if (dock.x == x && dock.y == y) {
+ cout << "Error: " << dock.coordinateName << " is already a dock\n";
+ return;
+ }
  }
  
- optimalPath.push_back(start);
- return optimalPath;
+ string name = "Dock " + to_string(docks.size() + 1);
+ docks.push_back(Location(x, y, name, getCoordinateName(x, y)));
+ computeDepotDistances();
+ publishSnapshot();
+ cout << name << " added at " << docks.back().coordinateName << "\n";
  }
  
- double calculatePathDistance(const vector<Location>& path) {
+ double calculatePathDistance(const vector<RouteStop>& path) const {
  double totalDistance = 0.0;
  for (int i = 0; i < path.size() - 1; i++) {
- totalDistance += path[i].distanceTo(path[i + 1]);
+ totalDistance += distance(path[i], path[i + 1]);
  }
  return totalDistance;
  }
  
- void displayDetailedPath(const vector<Location>& path) {
+ void displayDetailedPath(const vector<RouteStop>& path) {
  cout << "\n=== Detailed Picking Path ===\n";
  
  double totalTime = 0.0;
  double walkingSpeed = 2.0;
  
  for (int i = 0; i < path.size() - 1; i++) {
- Location from = path[i];
- Location to = path[i + 1];
- double segmentDist = from.distanceTo(to);
+ const RouteStop& from = path[i];
+ const RouteStop& to = path[i + 1];
+ string fromCell = getCoordinateName(from.x, from.y);
+ string toCell = getCoordinateName(to.x, to.y);
+ double segmentDist = distance(from, to);
  double segmentTime = segmentDist / walkingSpeed;
  totalTime += segmentTime;
  
  cout << "\n" << (i + 1) << ". ";
  
  if (i == 0) {
- cout << "START: " << from.coordinateName << " (" << from.name << ")";
+ cout << "START: " << fromCell << " (" << stopName(from) << ")";
  } else if (i == path.size() - 2) {
- cout << "PICK ITEM: " << from.name << " at " << from.coordinateName;
+ cout << "PICK ITEM: " << stopName(from) << " at " << fromCell;
  } else {
- cout << "PICK ITEM: " << from.name << " at " << from.coordinateName;
+ cout << "PICK ITEM: " << stopName(from) << " at " << fromCell;
  }
  
- cout << "\n -> Going to " << to.coordinateName << " (" << to.name << ")";
- 
- vector<Location> waypoints = generateWaypoints(from, to);
+ cout << "\n -> Going to " << toCell << " (" << stopName(to) << ")";
  
- if (!waypoints.empty()) {
- cout << "\n Path: " << from.coordinateName;
- for (const auto& wp : waypoints) {
- cout << " -> " << wp.coordinateName;
- }
+ if (from.x != to.x || from.y != to.y) {
+ cout << "\n Path: " << fromCell;
+ printWaypoints(from, to);
  } else {
- cout << "\n Direct path: " << from.coordinateName << " -> " << to.coordinateName;
+ cout << "\n Direct path: " << fromCell << " -> " << toCell;
  }
  
  cout << "\n Distance: " << fixed << setprecision(2) << segmentDist << " units";
@@ -442,143 +2271,202 @@ public:
  cout << string(50, '=') << "\n";
  }
  
- void displayPathOnMap(const vector<Location>& path) {
+ void displayPathOnMap(const vector<RouteStop>& path) {
  cout << "\n=== Path Visualization on Map ===\n";
  
- int maxX = 13, maxY = 10;
- vector<vector<string>> grid(maxY + 2, vector<string>(maxX + 2, "."));
+ int minX = path[0].x, minY = path[0].y;
+ for (const auto& loc : path) {
+ minX = min(minX, loc.x);
+ minY = min(minY, loc.y);
+ }
+ Viewport view = textViewport(minX, minY);
+ TextCanvas canvas(view);
  
  // Mark path
- for (int i = 0; i < path.size(); i++) {
+ for (size_t i = 0; i < path.size(); i++) {
  if (i == 0) {
- grid[path[i].y][path[i].x] = "S";
- } else if (i == path.size() - 1) {
- grid[path[i].y][path[i].x] = "E";
- } else {
- grid[path[i].y][path[i].x] = to_string(i);
- }
- }
- 
- cout << " ";
- for (int x = 0; x <= maxX; x++) {
- char col = 'A' + x;
- cout << " " << col;
- }
- cout << "\n";
- 
- for (int y = maxY; y >= 0; y--) {
- cout << setw(3) << (y + 1) << " ";
- for (int x = 0; x <= maxX; x++) {
- cout << setw(3) << grid[y][x];
- }
- cout << "\n";
- }
- 
- cout << "\nLegend:\n";
- cout << " S = Start (Entry)\n";
- cout << " 1-9 = Pick sequence\n";
- cout << " E = End/Return\n";
- cout << " . = Empty\n";
- }
- 
- void processNextOrder() {
- Order currentOrder(0);
- bool hasOrder = false;
- 
- if (!primeOrderQueue.empty()) {
- currentOrder = primeOrderQueue.top();
- primeOrderQueue.pop();
- hasOrder = true;
- cout << "\n" << string(60, '=') << "\n";
- cout << " Processing PRIME Order #" << currentOrder.orderId << "\n";
- cout << string(60, '=') << "\n";
- } else if (!regularOrderQueue.empty()) {
- currentOrder = regularOrderQueue.front();
- regularOrderQueue.pop();
- hasOrder = true;
- cout << "\n" << string(60, '=') << "\n";
- cout << " Processing Regular Order #" << currentOrder.orderId << "\n";
- cout << string(60, '=') << "\n";
- }
- 
- if (!hasOrder) {
- cout << "\nNo orders to process!\n";
- return;
- }
- 
- vector<Location> destinations;
- cout << "\nItems in this order:\n";
- 
- for (const auto& item : currentOrder.items) {
- Location* loc = getItemLocation(item.itemName);
- if (loc != nullptr) {
- destinations.push_back(*loc);
- auto it = items.find(item.itemName);
- string zone = (it != items.end() && it->second->assignedShelf->zone == HOT_ZONE) 
- ? "[HOT]" : "[COLD]";
- cout << " + " << item.itemName << " (Qty: " << item.quantity 
- << ") at " << loc->coordinateName << " " << zone << "\n";
+ canvas.put(path[i].x, path[i].y, "S");
+ } else if (i == path.size() - 1) {
+ canvas.put(path[i].x, path[i].y, "E");
  } else {
- cout << " - " << item.itemName << " - NOT FOUND!\n";
- }
+ canvas.put(path[i].x, path[i].y, to_string(i));
  }
- 
- if (destinations.empty()) {
- cout << "\nNo valid items. Order cannot be fulfilled.\n";
- return;
  }
  
- cout << "\nCalculating optimal route...\n";
- vector<Location> optimalPath = findOptimalPath(entryPoint, destinations);
- 
- displayDetailedPath(optimalPath);
- displayPathOnMap(optimalPath);
- 
- cout << "\n[OK] Order #" << currentOrder.orderId << " completed!\n";
+ canvas.print(cout);
+ printViewportNote(view);
  
- // Update frequencies and rebalance zones
- updateFrequencies(currentOrder);
- rebalanceZones();
+ cout << "\nLegend:\n";
+ cout << " S = Start (picker station)\n";
+ cout << " 1-9 = Pick sequence\n";
+ cout << " E = End (drop dock)\n";
+ cout << " . = Empty\n";
  }
  
- void displayWarehouseLayout() {
+ OrderResult processNextOrder() {
+ QueuedOrder next;
+ if (!takeNextOrder(next)) {
+ cout << "\nNo orders to process!\n";
+ return OrderResult();
+ }
+ 
+ currentWork.reset(0, next);
+ resolveOrder(currentWork);
+ uint32_t planStart = pickerDock;
+ planRoute(currentWork, planStart);
+ dispatchOrder(currentWork, pickerDock);
+ OrderResult result = commitOrder(currentWork);
+ 
+ reclaimOrderLines();
+ publishSnapshot();
+ return result;
+ }
+ 
+ // Processes every queued order through the staged pipeline: resolve and
+ // plan run on worker threads against read snapshots, while dispatch and
+ // commit run in intake order on this thread, publishing after each commit.
+ // Bounded queues between stages, and a cap of queueCapacity orders in
+ // flight, apply backpressure. Routing for later orders overlaps the
+ // commit of earlier ones.
+ vector<OrderResult> processAllOrdersPipelined(const PipelineConfig& config = PipelineConfig()) {
+ // Intake: the queues are drained up front so stage threads never touch them
+ vector<QueuedOrder> intake;
+ QueuedOrder next;
+ while (takeNextOrder(next)) intake.push_back(next);
+ publishSnapshot();
+ 
+ const size_t window = max<size_t>(1, config.queueCapacity);
+ BoundedQueue<PipelineOrder> toResolve(window), toPlan(window), toDispatch(window);
+ vector<OrderResult> results;
+ vector<thread> workers;
+ const int resolveWorkers = max(1, config.resolveWorkers), planWorkers = max(1, config.planWorkers);
+ const int pickers = max(1, config.pickers);
+ atomic<int> resolvers{resolveWorkers}, planners{planWorkers}; // Last one out closes the next queue
+ 
+ // Orders admitted but not yet dispatched; bounds the reorder buffer below
+ mutex windowLock;
+ condition_variable windowOpen;
+ uint64_t dispatched = 0;
+ 
+ workers.emplace_back([&] {
+ for (size_t i = 0; i < intake.size(); i++) {
+ {
+ unique_lock<mutex> guard(windowLock);
+ windowOpen.wait(guard, [&] { return i < dispatched + window; });
+ }
+ PipelineOrder work;
+ work.reset(i, intake[i]);
+ work.picker = static_cast<int>(i % pickers);
+ if (!toResolve.push(move(work))) break;
+ }
+ toResolve.close();
+ });
+ 
+ for (int w = 0; w < resolveWorkers; w++) {
+ workers.emplace_back([&] {
+ PipelineOrder work;
+ while (toResolve.pop(work)) {
+ resolveOrder(work);
+ toPlan.push(move(work));
+ }
+ if (--resolvers == 0) toPlan.close();
+ });
+ }
+ 
+ // Planners route from where each picker's latest planned tour ends. That
+ // is only a guess when orders are planned out of sequence; dispatch
+ // re-plans from the picker's real station, so the routes do not depend
+ // on timing.
+ mutex planLock;
+ vector<uint32_t> plannedStations(pickers, pickerDock);
+ for (int w = 0; w < planWorkers; w++) {
+ workers.emplace_back([&] {
+ PipelineOrder work;
+ while (toPlan.pop(work)) {
+ uint32_t station;
+ {
+ lock_guard<mutex> guard(planLock);
+ station = plannedStations[work.picker];
+ }
+ planRoute(work, station);
+ {
+ lock_guard<mutex> guard(planLock);
+ plannedStations[work.picker] = station;
+ }
+ toDispatch.push(move(work));
+ }
+ if (--planners == 0) toDispatch.close();
+ });
+ }
+ 
+ // Dispatch restores intake order, since parallel workers can finish out
+ // of order, and tracks where each picker actually is
+ vector<uint32_t> stations(pickers, pickerDock);
+ uint32_t lastStation = pickerDock;
+ size_t replanned = 0;
+ map<uint64_t, PipelineOrder> waiting;
+ PipelineOrder work;
+ while (toDispatch.pop(work)) {
+ waiting[work.sequence] = move(work);
+ while (!waiting.empty() && waiting.begin()->first == dispatched) {
+ PipelineOrder& ready = waiting.begin()->second;
+ if (dispatchOrder(ready, stations[ready.picker])) replanned++;
+ results.push_back(commitOrder(ready));
+ publishSnapshot();
+ if (!ready.route.empty()) lastStation = ready.route.back().dockIndex();
+ waiting.erase(waiting.begin());
+ {
+ lock_guard<mutex> guard(windowLock);
+ dispatched++;
+ }
+ windowOpen.notify_one();
+ }
+ }
+ 
+ for (auto& worker : workers) worker.join();
+ 
+ pickerDock = lastStation;
+ reclaimOrderLines();
+ publishSnapshot();
+ cout << "\n" << replanned << " of " << results.size() 
+ << " routes re-planned at dispatch (items or picker moved after planning)\n";
+ return results;
+ }
+ 
+ // True when the text map cannot show the whole floor at once
+ bool layoutNeedsViewport() const {
+ return floorWidth > MAX_TEXT_MAP_SIZE || floorHeight > MAX_TEXT_MAP_SIZE;
+ }
+ 
+ // Draws the text map from cell (x0, y0) as its lower-left corner; the
+ // frame is shifted back inside the floor if it would run off an edge
+ void displayWarehouseLayout(int x0 = 0, int y0 = 0) {
+ SnapshotPublisher::Reader view = readView();
  cout << "\n=== Warehouse Layout Matrix ===\n";
  
- int maxX = 13, maxY = 10;
- vector<vector<string>> grid(maxY + 2, vector<string>(maxX + 2, "."));
+ Viewport frame = textViewport(x0, y0);
+ TextCanvas canvas(frame);
  
- // Mark entry point
- grid[entryPoint.y][entryPoint.x] = "E";
+ // Mark docks
+ for (const auto& dock : view->docks) {
+ canvas.put(dock.x, dock.y, "E");
+ }
  
  // Map item names to codes
  unordered_map<string, int> itemCodes;
  int codeNum = 1;
  
- for (const auto& shelf : shelves) {
+ for (const auto& shelf : view->shelves) {
  if (!shelf.isEmpty()) {
  if (itemCodes.find(shelf.itemStored) == itemCodes.end()) {
  itemCodes[shelf.itemStored] = codeNum++;
  }
- grid[shelf.y][shelf.x] = to_string(itemCodes[shelf.itemStored]);
+ canvas.put(shelf.x, shelf.y, to_string(itemCodes[shelf.itemStored]));
  }
  }
  
- // Print column headers
- cout << " ";
- for (int x = 0; x <= maxX; x++) {
- char col = 'A' + x;
- cout << setw(3) << col;
- }
- cout << "\n";
- 
- // Print grid
- for (int y = maxY; y >= 0; y--) {
- cout << setw(4) << (y + 1) << " ";
- for (int x = 0; x <= maxX; x++) {
- cout << setw(3) << grid[y][x];
- }
- cout << "\n";
- }
+ canvas.print(cout);
+ printViewportNote(frame);
  
  // Print zone information
  cout << "\n=== Zone Configuration ===\n";
@@ -586,7 +2474,7 @@ public:
  vector<string> hotZoneShelves;
  vector<string> coldZoneShelves;
  
- for (const auto& shelf : shelves) {
+ for (const auto& shelf : view->shelves) {
  if (shelf.zone == HOT_ZONE) {
  hotZoneShelves.push_back(shelf.coordinateName);
  } else {
@@ -606,7 +2494,7 @@ public:
  
  // Print legend
  cout << "\n=== Legend ===\n";
- cout << " E = Entry Point (" << entryPoint.coordinateName << ")\n";
+ cout << " E = Entry Point / Dock (" << dockList(*view) << ")\n";
  cout << " 1-9 = Item code (see table below)\n";
  cout << " . = Empty shelf or space\n";
  
@@ -628,13 +2516,13 @@ public:
  string itemName = pair.first;
  int code = pair.second;
  
- auto it = items.find(itemName);
- if (it != items.end()) {
- Item* item = it->second;
- string zone = (item->assignedShelf->zone == HOT_ZONE) ? "HOT" : "COLD";
+ const ItemView* item = view->find(itemName);
+ if (item != nullptr) {
+ const Shelf& shelf = view->shelfOf(*item);
+ string zone = (shelf.zone == HOT_ZONE) ? "HOT" : "COLD";
  cout << left << setw(5) << code 
  << setw(20) << itemName
- << setw(12) << item->assignedShelf->coordinateName
+ << setw(12) << shelf.coordinateName
  << setw(10) << zone
  << setw(10) << item->frequency
  << item->size << "\n";
@@ -643,13 +2531,40 @@ public:
  }
  }
  
+ // Writes a downsampled heat map of the whole floor; the format follows the
+ // file extension (.svg or .ppm)
+ bool exportHeatMap(const string& path, HeatLayer layer) {
+ SnapshotPublisher::Reader view = readView();
+ HeatMap map = HeatMap::build(*view, layer, 512);
+ int pixelsPerBucket = max(1, 512 / max(map.width, map.height));
+ 
+ bool written;
+ if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".svg") == 0) {
+ written = map.writeSVG(path, pixelsPerBucket);
+ } else if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".ppm") == 0) {
+ written = map.writePPM(path, pixelsPerBucket);
+ } else {
+ cout << "Error: Heat map file must end in .svg or .ppm\n";
+ return false;
+ }
+ 
+ if (!written) {
+ cout << "Error: Cannot write " << path << "\n";
+ return false;
+ }
+ cout << "Heat map written to " << path << " (" << map.width << "x" << map.height 
+ << " buckets, " << map.scale << "x" << map.scale << " cells each)\n";
+ return true;
+ }
+ 
  void displayZones() {
+ SnapshotPublisher::Reader view = readView();
  cout << "\n=== Warehouse Zones Summary ===\n";
  
  int hotCount = 0, coldCount = 0;
  int hotItemCount = 0, coldItemCount = 0;
  
- for (const auto& shelf : shelves) {
+ for (const auto& shelf : view->shelves) {
  if (shelf.zone == HOT_ZONE) {
  hotCount++;
  if (!shelf.isEmpty()) hotItemCount++;
@@ -671,33 +2586,470 @@ public:
  }
  
  void displayInventory() {
+ SnapshotPublisher::Reader view = readView();
  cout << "\n=== Warehouse Inventory ===\n";
- cout << "Entry Point: " << entryPoint.coordinateName << "\n\n";
+ cout << "Docks: " << dockList(*view) << "\n\n";
  
  cout << left << setw(20) << "Item" << setw(10) << "Frequency" 
  << setw(8) << "Size" << setw(12) << "Location" 
  << setw(10) << "Zone" << "\n";
  cout << string(60, '-') << "\n";
  
- for (const auto& pair : items) {
- Item* item = pair.second;
- string zone = (item->assignedShelf->zone == HOT_ZONE) ? "HOT" : "COLD";
- cout << left << setw(20) << item->name 
- << setw(10) << item->frequency 
- << setw(8) << item->size
- << setw(12) << item->assignedShelf->coordinateName
+ for (const auto& item : view->items) {
+ if (item.shelfIndex < 0) continue;
+ const Shelf& shelf = view->shelfOf(item);
+ string zone = (shelf.zone == HOT_ZONE) ? "HOT" : "COLD";
+ cout << left << setw(20) << item.name 
+ << setw(10) << item.frequency 
+ << setw(8) << item.size
+ << setw(12) << shelf.coordinateName
  << setw(10) << zone << "\n";
  }
  }
  
  void displayQueues() {
+ SnapshotPublisher::Reader view = readView();
  cout << "\n=== Order Status ===\n";
- cout << "Prime Orders: " << primeOrderQueue.size() << "\n";
- cout << "Regular Orders: " << regularOrderQueue.size() << "\n";
+ cout << "Prime Orders: " << view->primeOrders << "\n";
+ cout << "Regular Orders: " << view->regularOrders << "\n";
  }
  
  bool hasPendingOrders() {
- return !primeOrderQueue.empty() || !regularOrderQueue.empty();
+ return !primeOrderQueue.empty() || regularHead < regularOrderQueue.size();
+ }
+};
+// Site configuration, chosen at build time, e.g.
+// -DWAREHOUSE_METRIC=ManhattanMetric -D'WAREHOUSE_BOUNDS=FixedBounds<64,64>'
+#ifndef WAREHOUSE_METRIC
+#define WAREHOUSE_METRIC EuclideanMetric
+#endif
+#ifndef WAREHOUSE_BOUNDS
+#define WAREHOUSE_BOUNDS DynamicBounds
+#endif
+typedef BasicWarehouseSystem<WAREHOUSE_METRIC, WAREHOUSE_BOUNDS> WarehouseSystem;
+// Line-oriented message channel over a stream socket
+class LineChannel {
+private:
+ int fd;
+ string pending;
+ 
+public:
+ explicit LineChannel(int socketFd = -1) : fd(socketFd) {}
+ 
+ int descriptor() const { return fd; }
+ 
+ bool writeLine(const string& line) {
+ string data = line + "\n";
+ size_t sent = 0;
+ while (sent < data.size()) {
+ ssize_t n = write(fd, data.data() + sent, data.size() - sent);
+ if (n < 0 && errno == EINTR) continue;
+ if (n <= 0) return false;
+ sent += n;
+ }
+ return true;
+ }
+ 
+ bool readLine(string& line) {
+ while (true) {
+ size_t newline = pending.find('\n');
+ if (newline != string::npos) {
+ line = pending.substr(0, newline);
+ pending.erase(0, newline + 1);
+ return true;
+ }
+ char buffer[4096];
+ ssize_t n = read(fd, buffer, sizeof(buffer));
+ if (n < 0 && errno == EINTR) continue;
+ if (n <= 0) return false;
+ pending.append(buffer, n);
+ }
+ }
+ 
+ void close() {
+ if (fd >= 0) ::close(fd);
+ fd = -1;
+ }
+};
+// Shard protocol: one request line, one reply line, fields separated by '|'
+//  ADD|name|freq|size            -> OK | ERR
+//  ORDER|id|prime|name|qty|...   -> OK
+//  PROCESS                       -> IDLE | DONE|id|picked|missing|distance
+//  MISPLACED                     -> ITEMS{|name|freq|size} (items stuck in the wrong zone)
+//  RELEASE|name                  -> ITEM|name|freq|size | ERR
+//  FREE|freq                     -> FREE|inZone|total|nearest (dock distance of the shelf it would use)
+//  DECAY|ticks                   -> OK (orders processed on other shards only)
+//  QUIT                          -> (shard exits)
+const char FIELD_SEPARATOR = '|';
+vector<string> splitFields(const string& line) {
+ vector<string> fields;
+ size_t start = 0;
+ while (true) {
+ size_t end = line.find(FIELD_SEPARATOR, start);
+ fields.push_back(line.substr(start, end - start));
+ if (end == string::npos) break;
+ start = end + 1;
+ }
+ return fields;
+}
+// Shard process main loop: serves one region of the floor until QUIT or EOF.
+// The shard's own console output is discarded; results go back to the router.
+void runShard(int fd, ShelfRegion region) {
+ cout.setstate(ios::failbit);
+ WarehouseSystem warehouse(0, 0, region);
+ LineChannel channel(fd);
+ string line;
+ 
+ while (channel.readLine(line)) {
+ vector<string> fields = splitFields(line);
+ const string& command = fields[0];
+ string reply = "ERR";
+ 
+ if (command == "ADD" && fields.size() == 4) {
+ bool added = warehouse.addItem(fields[1], atoi(fields[2].c_str()), atoi(fields[3].c_str()));
+ reply = added ? "OK" : "ERR";
+ } else if (command == "ORDER" && fields.size() >= 3 && fields.size() % 2 == 1) {
+ Order order(atoi(fields[1].c_str()), fields[2] == "1");
+ for (size_t i = 3; i + 1 < fields.size(); i += 2) {
+ order.addItem(fields[i], atoi(fields[i + 1].c_str()));
+ }
+ warehouse.addOrder(order);
+ reply = "OK";
+ } else if (command == "PROCESS") {
+ if (!warehouse.hasPendingOrders()) {
+ reply = "IDLE";
+ } else {
+ OrderResult result = warehouse.processNextOrder();
+ ostringstream out;
+ out << "DONE|" << result.orderId << "|" << result.picked << "|" 
+ << result.missing << "|" << result.distance;
+ reply = out.str();
+ }
+ } else if (command == "MISPLACED") {
+ reply = "ITEMS";
+ for (const auto& item : warehouse.misplacedItems()) {
+ reply += "|" + item.name + "|" + to_string(item.frequency) + "|" + to_string(item.size);
+ }
+ } else if (command == "RELEASE" && fields.size() == 2) {
+ optional<PutAwayRequest> item = warehouse.releaseItem(fields[1]);
+ if (item) {
+ reply = "ITEM|" + item->name + "|" + to_string(item->frequency) + "|" + 
+ to_string(item->size);
+ }
+ } else if (command == "FREE" && fields.size() == 2) {
+ ShelfAvailability free = warehouse.freeShelves(atoi(fields[1].c_str()));
+ ostringstream out;
+ out << "FREE|" << free.inZone << "|" << free.total << "|" << free.nearest;
+ reply = out.str();
+ } else if (command == "DECAY" && fields.size() == 2) {
+ warehouse.decayFrequencies(atoi(fields[1].c_str()));
+ reply = "OK";
+ } else if (command == "QUIT") {
+ break;
+ }
+ 
+ if (!channel.writeLine(reply)) break;
+ }
+ channel.close();
+}
+// Partitioned deployment: each shard is a child process owning a strip of
+// shelf columns and the items stored there. The router places items on
+// shards, splits orders by item ownership, merges completions, and hands
+// items over to another shard when their zone only exists elsewhere.
+// Shards talk to the router over Unix socket pairs, so everything runs on
+// one Linux machine.
+class ShardRouter {
+private:
+ struct Shard {
+ pid_t pid;
+ LineChannel channel;
+ ShelfRegion region;
+ };
+ 
+ // Merged state of an order whose sub-orders are still running
+ struct SplitOrder {
+ int remaining;
+ int shardCount;
+ OrderResult merged;
+ vector<bool> onShard; // Shards holding one of its sub-orders
+ };
+ 
+ vector<Shard> shards;
+ unordered_map<string, int> owners; // item name -> shard index
+ unordered_map<int, SplitOrder> splitOrders;
+ vector<int> decayTicks; // Per shard: completed orders it had no part in, not yet sent
+ 
+ string request(int shard, const string& line) {
+ string reply;
+ if (!shards[shard].channel.writeLine(line) || !shards[shard].channel.readLine(reply)) {
+ return "ERR";
+ }
+ return reply;
+ }
+ 
+ string describe(int shard) const {
+ return "shard " + to_string(shard + 1) + " (" + columnName(shards[shard].region.minX) + 
+ "-" + columnName(shards[shard].region.maxX) + ")";
+ }
+ 
+ // Shard whose placement would land nearest a dock: shards with a free
+ // shelf in the item's zone first, then the nearest shelf, then the most
+ // free shelves. -1 if every candidate is full.
+ int pickShard(int frequency, int excluded, bool requireZone) {
+ int best = -1;
+ ShelfAvailability bestFree;
+ for (int i = 0; i < (int)shards.size(); i++) {
+ if (i == excluded) continue;
+ vector<string> reply = splitFields(request(i, "FREE|" + to_string(frequency)));
+ if (reply.size() != 4 || reply[0] != "FREE") continue;
+ ShelfAvailability free;
+ free.inZone = atoi(reply[1].c_str());
+ free.total = atoi(reply[2].c_str());
+ free.nearest = atof(reply[3].c_str());
+ if (free.total == 0 || (requireZone && free.inZone == 0)) continue;
+ 
+ bool better = (best == -1);
+ if (!better && (free.inZone > 0) != (bestFree.inZone > 0)) {
+ better = free.inZone > 0;
+ } else if (!better && free.nearest != bestFree.nearest) {
+ better = free.nearest < bestFree.nearest;
+ } else if (!better) {
+ better = make_pair(free.inZone, free.total) > make_pair(bestFree.inZone, bestFree.total);
+ }
+ if (better) {
+ best = i;
+ bestFree = free;
+ }
+ }
+ return best;
+ }
+ 
+ // Moves an item to a shard that has a free shelf in its zone
+ void handOff(const string& name, int frequency, int from) {
+ int target = pickShard(frequency, from, true);
+ if (target == -1) return;
+ 
+ vector<string> released = splitFields(request(from, "RELEASE|" + name));
+ if (released.size() != 4 || released[0] != "ITEM") return;
+ 
+ string add = "ADD|" + name + "|" + released[2] + "|" + released[3];
+ if (request(target, add) == "OK") {
+ owners[name] = target;
+ cout << " ⇄ Handed '" << name << "' (freq=" << released[2] << ") from " 
+ << describe(from) << " to " << describe(target) << "\n";
+ } else if (request(from, add) != "OK") {
+ owners.erase(name);
+ cout << " ✗ Lost '" << name << "' (freq=" << released[2] << ", size=" << released[3] 
+ << "): " << describe(target) << " refused it and " << describe(from) 
+ << " could not take it back\n";
+ }
+ }
+ 
+ void completeSubOrder(const vector<string>& reply) {
+ int orderId = atoi(reply[1].c_str());
+ auto it = splitOrders.find(orderId);
+ if (it != splitOrders.end()) {
+ SplitOrder& split = it->second;
+ split.merged.picked += atoi(reply[2].c_str());
+ split.merged.missing += atoi(reply[3].c_str());
+ split.merged.distance += atof(reply[4].c_str());
+ if (--split.remaining == 0) {
+ cout << "[OK] Order #" << orderId << " completed across " << split.shardCount 
+ << " shard(s): " << split.merged.picked << " picked, " << split.merged.missing 
+ << " missing, " << fixed << setprecision(2) << split.merged.distance 
+ << " units walked\n";
+ for (size_t i = 0; i < shards.size(); i++) {
+ if (!split.onShard[i]) decayTicks[i]++;
+ }
+ splitOrders.erase(it);
+ }
+ }
+ }
+ 
+public:
+ // Splits the shelf columns of the built-in layout into shardCount strips
+ explicit ShardRouter(int shardCount) {
+ signal(SIGPIPE, SIG_IGN);
+ int columns = LAYOUT_WIDTH;
+ 
+ for (int i = 0; i < shardCount; i++) {
+ ShelfRegion region;
+ region.minX = i * columns / shardCount;
+ region.maxX = (i + 1) * columns / shardCount - 1;
+ 
+ int fds[2];
+ if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+ cout << "Error: Cannot create shard socket\n";
+ break;
+ }
+ cout.flush();
+ pid_t pid = fork();
+ if (pid < 0) {
+ cout << "Error: Cannot start shard process\n";
+ ::close(fds[0]);
+ ::close(fds[1]);
+ break;
+ }
+ if (pid == 0) {
+ ::close(fds[0]);
+ for (auto& shard : shards) shard.channel.close();
+ runShard(fds[1], region);
+ _exit(0);
+ }
+ ::close(fds[1]);
+ shards.push_back(Shard{pid, LineChannel(fds[0]), region});
+ }
+ 
+ decayTicks.assign(shards.size(), 0);
+ cout << "Started " << shards.size() << " shard processes:";
+ for (int i = 0; i < (int)shards.size(); i++) {
+ cout << (i == 0 ? " " : ", ") << describe(i);
+ }
+ cout << "\n";
+ }
+ 
+ ShardRouter(const ShardRouter&) = delete;
+ ShardRouter& operator=(const ShardRouter&) = delete;
+ 
+ ~ShardRouter() {
+ for (auto& shard : shards) {
+ shard.channel.writeLine("QUIT");
+ shard.channel.close();
+ waitpid(shard.pid, nullptr, 0);
+ }
+ }
+ 
+ bool addItem(const string& itemName, int frequency, int size) {
+ if (itemName.find(FIELD_SEPARATOR) != string::npos) {
+ cout << "Error: Item names cannot contain '" << FIELD_SEPARATOR << "'\n";
+ return false;
+ }
+ if (owners.count(itemName)) {
+ cout << "Error: Item '" << itemName << "' is already stored\n";
+ return false;
+ }
+ 
+ int shard = pickShard(frequency, -1, false);
+ string add = "ADD|" + itemName + "|" + to_string(frequency) + "|" + to_string(size);
+ if (shard == -1 || request(shard, add) != "OK") {
+ cout << "Error: Could not place " << itemName << "\n";
+ return false;
+ }
+ owners[itemName] = shard;
+ cout << "Added '" << itemName << "' to " << describe(shard) << "\n";
+ return true;
+ }
+ 
+ // Receipt file as for WarehouseSystem::putAwayFromFile. Items are placed
+ // highest frequency first, so hot items claim the shelves nearest a dock
+ // across all shards.
+ PutAwayReport putAwayFromFile(const string& path) {
+ PutAwayReport report;
+ vector<PutAwayRequest> requests;
+ if (!readPutAwayFile(path, requests, report.rejections)) return report;
+ 
+ stable_sort(requests.begin(), requests.end(), 
+ [](const PutAwayRequest& a, const PutAwayRequest& b) { 
+ return a.frequency > b.frequency; 
+ });
+ for (const auto& request : requests) {
+ if (addItem(request.name, request.frequency, request.size)) {
+ report.placed++;
+ } else {
+ report.rejections.push_back({request.name, "Not placed"});
+ }
+ }
+ cout << "Put-away complete: " << report.placed << " placed, " 
+ << report.rejections.size() << " rejected\n";
+ return report;
+ }
+ 
+ // Splits the order by item ownership and queues one sub-order per shard
+ void addOrder(const Order& order) {
+ vector<string> subOrders(shards.size());
+ int missing = 0;
+ for (const auto& line : order.items) {
+ auto owner = owners.find(line.itemName);
+ if (owner == owners.end()) {
+ missing++;
+ continue;
+ }
+ string& subOrder = subOrders[owner->second];
+ if (subOrder.empty()) {
+ subOrder = "ORDER|" + to_string(order.orderId) + "|" + (order.isPrime ? "1" : "0");
+ }
+ subOrder += "|" + line.itemName + "|" + to_string(line.quantity);
+ }
+ 
+ SplitOrder split{0, 0, OrderResult(), vector<bool>(shards.size(), false)};
+ split.merged.orderId = order.orderId;
+ split.merged.missing = missing;
+ for (int i = 0; i < (int)shards.size(); i++) {
+ if (!subOrders[i].empty() && request(i, subOrders[i]) == "OK") {
+ split.onShard[i] = true;
+ split.remaining++;
+ }
+ }
+ split.shardCount = split.remaining;
+ 
+ if (split.remaining == 0) {
+ cout << "Order #" << order.orderId << ": no items found in any shard\n";
+ return;
+ }
+ splitOrders[order.orderId] = split;
+ cout << (order.isPrime ? "Prime" : "Regular") << " Order #" << order.orderId 
+ << " split into " << split.remaining << " sub-order(s)\n";
+ }
+ 
+ // Hands every item stuck in the wrong zone of its shard to a shard with
+ // room in the right zone. Run between waves, so no queued sub-order can
+ // lose an item it expects to find.
+ void rebalanceShards() {
+ for (int i = 0; i < (int)shards.size(); i++) {
+ vector<string> reply = splitFields(request(i, "MISPLACED"));
+ if (reply[0] != "ITEMS") continue;
+ for (size_t j = 1; j + 2 < reply.size(); j += 3) {
+ handOff(reply[j], atoi(reply[j + 1].c_str()), i);
+ }
+ }
+ }
+ 
+ // Runs the shards in parallel, one order per shard per round, until every
+ // queue is empty, then rebalances across shards
+ void processAllOrders() {
+ vector<bool> active(shards.size(), true);
+ bool anyActive = true;
+ 
+ while (anyActive) {
+ for (int i = 0; i < (int)shards.size(); i++) {
+ if (active[i] && !shards[i].channel.writeLine("PROCESS")) active[i] = false;
+ }
+ 
+ anyActive = false;
+ for (int i = 0; i < (int)shards.size(); i++) {
+ if (!active[i]) continue;
+ string line;
+ if (!shards[i].channel.readLine(line)) {
+ active[i] = false;
+ continue;
+ }
+ vector<string> reply = splitFields(line);
+ if (reply[0] == "DONE" && reply.size() >= 5) {
+ completeSubOrder(reply);
+ anyActive = true;
+ } else {
+ active[i] = false;
+ }
+ }
+ 
+ // Every reply of the round is in, so the channels are free again
+ for (int i = 0; i < (int)shards.size(); i++) {
+ if (decayTicks[i] > 0) request(i, "DECAY|" + to_string(decayTicks[i]));
+ decayTicks[i] = 0;
+ }
+ }
+ 
+ rebalanceShards();
  }
 };
 void displayMenu() {
@@ -714,11 +3066,56 @@ void displayMenu() {
  cout << "8. Search Item Location\n";
  cout << "9. Process All Orders\n";
  cout << "10. Load Sample Data\n";
+ cout << "11. Bulk Put-Away from File\n";
+ cout << "12. Export Heat Map (SVG/PPM)\n";
+ cout << "13. Add Dock Door\n";
+ cout << "14. Process All Orders (Pipelined)\n";
+ cout << "15. What-If Swap (Order History)\n";
+ cout << "0. Exit\n";
+ cout << "========================================\n";
+ cout << "Enter your choice: ";
+}
+// Partitioned mode offers the operations the router supports
+void displayShardMenu() {
+ cout << "\n========================================\n";
+ cout << " PARTITIONED WAREHOUSE - MENU\n";
+ cout << "========================================\n";
+ cout << "1. Add Item (with frequency)\n";
+ cout << "2. Create New Order\n";
+ cout << "3. Process All Orders\n";
+ cout << "4. Bulk Put-Away from File\n";
+ cout << "5. Load Sample Data\n";
  cout << "0. Exit\n";
  cout << "========================================\n";
  cout << "Enter your choice: ";
 }
-void loadSampleData(WarehouseSystem& warehouse) {
+// Prompts for an order's lines; shared by both menus
+Order readOrder(int orderId) {
+ char isPrime;
+ int numItems;
+ cout << "\nIs this a Prime order? (y/n): ";
+ cin >> isPrime;
+ bool prime = (isPrime == 'y' || isPrime == 'Y');
+ Order newOrder(orderId, prime);
+ cout << "How many items? ";
+ cin >> numItems;
+ cin.ignore();
+ 
+ for (int i = 0; i < numItems; i++) {
+ string itemName;
+ int quantity;
+ cout << " Item " << (i + 1) << " name: ";
+ getline(cin, itemName);
+ cout << " Quantity: ";
+ cin >> quantity;
+ cin.ignore();
+ newOrder.addItem(itemName, quantity);
+ }
+ return newOrder;
+}
+// Works with a WarehouseSystem or a ShardRouter
+template<typename Target>
+void loadSampleData(Target& warehouse) {
  cout << "\nLoading sample data...\n\n";
  
  warehouse.addItem("Laptop", 85, 150);
@@ -749,7 +3146,122 @@ void loadSampleData(WarehouseSystem& warehouse) {
  
  cout << "\nSample data loaded!\n";
 }
-int main() {
+// Benchmark: "--bench [tours]" scores the same random tours (40 picks each,
+// from the entry at A1 to the nearest dock) on the standard shelf layout
+// under every metric, on one thread, so the metrics can be compared
+template<typename Metric>
+void benchMetric(int tours) {
+ typedef typename LayoutEvaluator<Metric>::Cell Cell;
+ const size_t LINES_PER_TOUR = 40;
+ vector<Cell> shelfCells;
+ for (int y = 1; y < LAYOUT_HEIGHT; y++) {
+ for (int x = 1; x < LAYOUT_WIDTH; x++) shelfCells.push_back(Cell{x, y});
+ }
+ 
+ LayoutEvaluator<Metric> evaluator({Cell{0, 0}}, shelfCells, 1);
+ mt19937 random(42); // Fixed seed: every metric walks the same tours
+ uniform_int_distribution<ItemId> pick(0, static_cast<ItemId>(shelfCells.size() - 1));
+ vector<ItemId> tour(LINES_PER_TOUR);
+ for (int i = 0; i < tours; i++) {
+ for (auto& id : tour) id = pick(random);
+ evaluator.addOrder(tour.data(), tour.size());
+ }
+ 
+ auto start = chrono::steady_clock::now();
+ double total = evaluator.evaluate();
+ double micros = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+ cout << left << setw(26) << Metric::NAME << right << fixed << setprecision(2) 
+ << setw(10) << micros / tours << setw(14) << total / tours << "\n";
+}
+int runBench(int tours) {
+ if (tours < 1) {
+ cout << "Error: Tour count must be positive\n";
+ return 1;
+ }
+ cout << tours << " random 40-pick tours on the " << LAYOUT_WIDTH << "x" << LAYOUT_HEIGHT << " floor\n";
+ cout << left << setw(26) << "Metric" << right << setw(10) << "us/tour" << setw(14) << "units/tour" << "\n";
+ benchMetric<EuclideanMetric>(tours);
+ benchMetric<ManhattanMetric>(tours);
+ benchMetric<AisleMetric<5>>(tours);
+ return 0;
+}
+// Partitioned mode: "--shards N" serves the shard menu over N shard processes
+int runSharded(int shardCount) {
+ if (shardCount < 1 || shardCount > LAYOUT_WIDTH) {
+ cout << "Error: Shard count must be between 1-" << LAYOUT_WIDTH << "\n";
+ return 1;
+ }
+ ShardRouter router(shardCount);
+ int choice, orderCounter = 1;
+ bool running = true;
+ 
+ while (running) {
+ displayShardMenu();
+ if (!(cin >> choice)) break;
+ cin.ignore(numeric_limits<streamsize>::max(), '\n');
+ 
+ switch (choice) {
+ case 1: {
+ string itemName;
+ int frequency, size;
+ cout << "\nEnter item name: ";
+ getline(cin, itemName);
+ cout << "Enter access frequency (0-100): ";
+ cin >> frequency;
+ cout << "Enter item size (1-1000): ";
+ cin >> size;
+ cin.ignore();
+ router.addItem(itemName, frequency, size);
+ break;
+ }
+ 
+ case 2: {
+ router.addOrder(readOrder(orderCounter++));
+ break;
+ }
+ 
+ case 3: {
+ cout << "\nProcessing all orders...\n";
+ router.processAllOrders();
+ cout << "\nAll orders done!\n";
+ break;
+ }
+ 
+ case 4: {
+ string path;
+ cout << "\nEnter receipt file (name,frequency,size per line): ";
+ getline(cin, path);
+ router.putAwayFromFile(path);
+ break;
+ }
+ 
+ case 5: {
+ loadSampleData(router);
+ orderCounter = max(orderCounter, 4);
+ break;
+ }
+ 
+ case 0: {
+ running = false;
+ break;
+ }
+ 
+ default: {
+ cout << "\nInvalid choice!\n";
+ break;
+ }
+ }
+ }
+ return 0;
+}
+int main(int argc, char* argv[]) {
+ if (argc == 3 && string(argv[1]) == "--shards") {
+ return runSharded(atoi(argv[2]));
+ }
+ if ((argc == 2 || argc == 3) && string(argv[1]) == "--bench") {
+ return runBench(argc == 3 ? atoi(argv[2]) : 20000);
+ }
+ 
  cout << "========================================\n";
  cout << " WAREHOUSE MANAGEMENT SYSTEM\n";
  cout << " with Dynamic Zone Rebalancing\n";
@@ -780,27 +3292,7 @@ int main() {
  }
  
  case 2: {
- char isPrime;
- int numItems;
- cout << "\nIs this a Prime order? (y/n): ";
- cin >> isPrime;
- bool prime = (isPrime == 'y' || isPrime == 'Y');
- Order newOrder(orderCounter++, prime);
- cout << "How many items? ";
- cin >> numItems;
- cin.ignore();
- 
- for (int i = 0; i < numItems; i++) {
- string itemName;
- int quantity;
- cout << " Item " << (i + 1) << " name: ";
- getline(cin, itemName);
- cout << " Quantity: ";
- cin >> quantity;
- cin.ignore();
- newOrder.addItem(itemName, quantity);
- }
- warehouse.addOrder(newOrder);
+ warehouse.addOrder(readOrder(orderCounter++));
  break;
  }
  
@@ -812,7 +3304,17 @@ int main() {
  }
  
  case 4: {
- warehouse.displayWarehouseLayout();
+ int x = 0, y = 0;
+ if (warehouse.layoutNeedsViewport()) {
+ string coordinate;
+ cout << "\nLower-left cell to show (e.g. A1, Enter for A1): ";
+ getline(cin, coordinate);
+ if (!coordinate.empty() && !parseCoordinateName(coordinate, x, y)) {
+ cout << "Invalid location, showing from A1\n";
+ x = y = 0;
+ }
+ }
+ warehouse.displayWarehouseLayout(x, y);
  cout << "\nPress Enter...";
  cin.get();
  break;
@@ -843,8 +3345,8 @@ int main() {
  string itemName;
  cout << "\nEnter item name: ";
  getline(cin, itemName);
- Location* loc = warehouse.getItemLocation(itemName);
- if (loc != nullptr) {
+ optional<Location> loc = warehouse.getItemLocation(itemName);
+ if (loc) {
  cout << "\nFound at " << loc->coordinateName << "\n";
  } else {
  cout << "\nNot found!\n";
@@ -877,6 +3379,75 @@ int main() {
  break;
  }
  
+ case 11: {
+ string path;
+ cout << "\nEnter receipt file (name,frequency,size per line): ";
+ getline(cin, path);
+ warehouse.putAwayFromFile(path);
+ cout << "\nPress Enter...";
+ cin.get();
+ break;
+ }
+ 
+ case 12: {
+ int layer;
+ string path;
+ cout << "\nLayer (1 = occupancy, 2 = frequency, 3 = path density): ";
+ cin >> layer;
+ cin.ignore(numeric_limits<streamsize>::max(), '\n');
+ cout << "Output file (.svg or .ppm): ";
+ getline(cin, path);
+ if (layer >= 1 && layer <= 3) {
+ warehouse.exportHeatMap(path, static_cast<HeatLayer>(layer - 1));
+ } else {
+ cout << "\nInvalid layer!\n";
+ }
+ cout << "\nPress Enter...";
+ cin.get();
+ break;
+ }
+ 
+ case 13: {
+ string coordinate;
+ cout << "\nEnter dock location (e.g. N1): ";
+ getline(cin, coordinate);
+ int x, y;
+ if (parseCoordinateName(coordinate, x, y)) {
+ warehouse.addDock(x, y);
+ } else {
+ cout << "\nInvalid location!\n";
+ }
+ cout << "\nPress Enter...";
+ cin.get();
+ break;
+ }
+ 
+ case 14: {
+ PipelineConfig config;
+ cout << "\nPickers: ";
+ cin >> config.pickers;
+ cout << "Route planning threads: ";
+ cin >> config.planWorkers;
+ cin.ignore(numeric_limits<streamsize>::max(), '\n');
+ vector<OrderResult> results = warehouse.processAllOrdersPipelined(config);
+ cout << "\n" << results.size() << " orders processed\n";
+ cout << "\nPress Enter...";
+ cin.get();
+ break;
+ }
+ 
+ case 15: {
+ string first, second;
+ cout << "\nFirst item: ";
+ getline(cin, first);
+ cout << "Second item: ";
+ getline(cin, second);
+ warehouse.whatIfSwap(first, second);
+ cout << "\nPress Enter...";
+ cin.get();
+ break;
+ }
+ 
  case 0: {
  cout << "\nThank you! Goodbye!\n";
  running = false;